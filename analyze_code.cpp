@@ -556,6 +556,231 @@ static void performIntraBlockAnalysis(PyCodeBlock &block, IntVPC end_vpc,
     }
 }
 
+// Note: A value remembers the local variable it is loaded from,
+//  and a boolean remembers the local variable it has compared with None,
+//  so that a conditional jump can narrow the type of that local variable on one of its edges.
+struct InferredValue {
+    KnownType type;
+    int loaded_from;
+    int tested_local;
+    bool tested_is_none;
+};
+
+struct TypeNarrowing {
+    int local;
+    bool on_branch;
+};
+
+static TypeNarrowing performTypeInference(PyCodeBlock &block, IntVPC end_vpc, PyCode py_code,
+        InferredValue *stack, KnownType *local_types, KnownType *loaded_types) {
+    auto first_instr = py_code.instrData();
+    auto sp = stack;
+    const auto &push = [&sp](KnownType type, int loaded_from = -1) {
+        *sp++ = {type, loaded_from, -1, false};
+    };
+    for ([[maybe_unused]] auto _ : IntRange(block.initial_stack_height)) {
+        push(KnownType::ANY);
+    }
+
+    PyOparg extended_oparg = 0;
+    for (auto vpc : IntRange(block.begin_vpc, end_vpc)) {
+        auto opcode = _Py_OPCODE(first_instr[vpc]);
+        auto oparg = _Py_OPARG(first_instr[vpc]) | extended_oparg;
+        extended_oparg = 0;
+
+        switch (opcode) {
+        case EXTENDED_ARG:
+            extended_oparg = oparg << PyCode::extended_arg_shift;
+            break;
+        case NOP:
+            break;
+        case ROT_TWO:
+            std::rotate(sp - 2, sp - 1, sp);
+            break;
+        case ROT_THREE:
+            std::rotate(sp - 3, sp - 1, sp);
+            break;
+        case ROT_FOUR:
+            std::rotate(sp - 4, sp - 1, sp);
+            break;
+        case ROT_N:
+            std::rotate(sp - oparg, sp - 1, sp);
+            break;
+        case DUP_TOP:
+            sp[0] = sp[-1];
+            sp += 1;
+            break;
+        case DUP_TOP_TWO:
+            sp[0] = sp[-2];
+            sp[1] = sp[-1];
+            sp += 2;
+            break;
+        case POP_TOP:
+            sp--;
+            break;
+
+        case LOAD_CONST:
+            push(classifyType(Py_TYPE(PyTuple_GET_ITEM(py_code->co_consts, oparg))));
+            break;
+        case LOAD_FAST:
+            loaded_types[vpc] = local_types[oparg];
+            push(local_types[oparg], oparg);
+            break;
+        case STORE_FAST:
+        case DELETE_FAST: {
+            local_types[oparg] = opcode == STORE_FAST ? (--sp)->type : KnownType::ANY;
+            for (auto &v : PtrRange(stack, sp - stack)) {
+                v.loaded_from = v.loaded_from == static_cast<int>(oparg) ? -1 : v.loaded_from;
+                v.tested_local = v.tested_local == static_cast<int>(oparg) ? -1 : v.tested_local;
+            }
+            break;
+        }
+        case LOAD_GLOBAL:
+        case LOAD_NAME:
+        case LOAD_DEREF:
+        case LOAD_CLASSDEREF:
+        case LOAD_CLOSURE:
+        case LOAD_BUILD_CLASS:
+        case LOAD_ASSERTION_ERROR:
+            push(KnownType::ANY);
+            break;
+        case STORE_GLOBAL:
+        case STORE_NAME:
+        case STORE_DEREF:
+            sp--;
+            break;
+        case LOAD_ATTR:
+        case GET_ITER:
+            sp--;
+            push(KnownType::ANY);
+            break;
+        case LOAD_METHOD:
+            sp--;
+            push(KnownType::ANY);
+            push(KnownType::ANY);
+            break;
+        case STORE_ATTR:
+            sp -= 2;
+            break;
+        case STORE_SUBSCR:
+            sp -= 3;
+            break;
+
+        case UNARY_NOT:
+        case UNARY_POSITIVE:
+        case UNARY_NEGATIVE:
+        case UNARY_INVERT: {
+            auto operand = (--sp)->type;
+            push(inferUnaryResultType(opcode, operand));
+            break;
+        }
+        case BINARY_ADD:
+        case INPLACE_ADD:
+        case BINARY_SUBTRACT:
+        case INPLACE_SUBTRACT:
+        case BINARY_MULTIPLY:
+        case INPLACE_MULTIPLY:
+        case BINARY_FLOOR_DIVIDE:
+        case INPLACE_FLOOR_DIVIDE:
+        case BINARY_TRUE_DIVIDE:
+        case INPLACE_TRUE_DIVIDE:
+        case BINARY_MODULO:
+        case INPLACE_MODULO:
+        case BINARY_POWER:
+        case INPLACE_POWER:
+        case BINARY_MATRIX_MULTIPLY:
+        case INPLACE_MATRIX_MULTIPLY:
+        case BINARY_LSHIFT:
+        case INPLACE_LSHIFT:
+        case BINARY_RSHIFT:
+        case INPLACE_RSHIFT:
+        case BINARY_AND:
+        case INPLACE_AND:
+        case BINARY_OR:
+        case INPLACE_OR:
+        case BINARY_XOR:
+        case INPLACE_XOR:
+        case BINARY_SUBSCR:
+        case COMPARE_OP: {
+            sp -= 2;
+            push(inferBinaryResultType(opcode, sp[0].type, sp[1].type));
+            break;
+        }
+        case IS_OP: {
+            sp -= 2;
+            auto tested_local = sp[1].type == KnownType::NONE ? sp[0].loaded_from
+                    : sp[0].type == KnownType::NONE ? sp[1].loaded_from : -1;
+            *sp++ = {KnownType::BOOL, -1, tested_local, !oparg};
+            break;
+        }
+        case CONTAINS_OP:
+            sp -= 2;
+            push(KnownType::BOOL);
+            break;
+
+        case CALL_FUNCTION:
+            sp -= oparg + 1;
+            push(KnownType::ANY);
+            break;
+        case CALL_METHOD:
+        case CALL_FUNCTION_KW:
+            sp -= oparg + 2;
+            push(KnownType::ANY);
+            break;
+
+        case BUILD_STRING:
+            sp -= oparg;
+            push(KnownType::STR);
+            break;
+        case BUILD_TUPLE:
+            sp -= oparg;
+            push(KnownType::TUPLE);
+            break;
+        case BUILD_LIST:
+            sp -= oparg;
+            push(KnownType::LIST);
+            break;
+        case BUILD_MAP:
+            sp -= 2 * oparg;
+            push(KnownType::DICT);
+            break;
+        case BUILD_CONST_KEY_MAP:
+            sp -= oparg + 1;
+            push(KnownType::DICT);
+            break;
+        case LIST_TO_TUPLE:
+            sp--;
+            push(KnownType::TUPLE);
+            break;
+        case FORMAT_VALUE:
+            sp -= 1 + ((oparg & FVS_MASK) == FVS_HAVE_SPEC);
+            push(KnownType::STR);
+            break;
+        case GET_LEN:
+            push(KnownType::INT);
+            break;
+
+        case POP_JUMP_IF_TRUE:
+        case POP_JUMP_IF_FALSE: {
+            auto cond = *--sp;
+            if (cond.tested_local >= 0) {
+                return {cond.tested_local, (opcode == POP_JUMP_IF_TRUE) == cond.tested_is_none};
+            }
+            break;
+        }
+
+        default:
+            // Note: any other instruction forgets what is known about the stack
+            sp += PyCompile_OpcodeStackEffectWithJump(opcode, oparg, 0);
+            for (auto &v : PtrRange(stack, sp - stack)) {
+                v = {KnownType::ANY, -1, -1, false};
+            }
+            break;
+        }
+    }
+    return {-1, false};
+}
+
 struct PyEhBlock : PyAnalysisBlock {
     struct PyCodeBlock *declarer;
 };
@@ -644,6 +869,7 @@ void CompilationUnit::parsePyCode() {
                 b.begin_vpc = begin_vpc;
                 b.llvm_block = createBlock(nullptr, "PyBlock");
                 b.handler_pc = nullptr;
+                b.predecessor_num = 0;
 
                 auto tail_opcode = read_opcode(end_vpc - 1);
 
@@ -808,6 +1034,7 @@ void CompilationUnit::parsePyCode() {
             }) {
                 if (possible_successor) {
                     auto &successor = *static_cast<PyCodeBlock *>(possible_successor);
+                    successor.predecessor_num++;
                     auto height = b.initial_stack_height + b.stack_effect + difference;
                     assert(0 <= height && height <= py_code->co_stacksize);
                     // a block's worklist_link points to itself if it is not visited
@@ -822,4 +1049,160 @@ void CompilationUnit::parsePyCode() {
             }
         } while (worklist_head);
     }
+
+    // Inter-block analysis: infer the exact types of local variables with Fixed Point Algorithm
+    {
+        auto nlocals = py_code->co_nlocals;
+        loaded_types.reserve(py_code.instrNum());
+        std::fill_n(loaded_types + 0, py_code.instrNum(), KnownType::ANY);
+        DynamicArray<KnownType> block_input(block_num * nlocals);
+        ManagedBitArray block_reached(block_num);
+        DynamicArray<KnownType> local_types(nlocals);
+        DynamicArray<InferredValue> stack(py_code->co_stacksize);
+
+        PyAnalysisBlock *worklist_head = nullptr;
+        const auto &merge_into = [&](PyCodeBlock &b, TypeNarrowing narrowing) {
+            size_t index = &b - blocks;
+            auto input = block_input + index * nlocals;
+            auto any_update = block_reached.testAndSet(index);
+            for (auto i : IntRange(nlocals)) {
+                auto type = narrowing.local == i ? KnownType::NONE : local_types[i];
+                if (any_update) {
+                    input[i] = type;
+                } else if (input[i] != type && input[i] != KnownType::ANY) {
+                    input[i] = KnownType::ANY;
+                    any_update = true;
+                }
+            }
+            if (any_update && b.worklist_link == &b) {
+                b.worklist_link = worklist_head;
+                worklist_head = &b;
+            }
+        };
+
+        // a block's worklist_link points to itself if it is not in worklist
+        for (auto &b : PtrRange(blocks, block_num)) {
+            b.worklist_link = &b;
+        }
+        // Note: an exception handler can be entered from anywhere in its try block, so nothing is assumed there
+        std::fill_n(local_types + 0, nlocals, KnownType::ANY);
+        for (auto &b : PtrRange(blocks, block_num)) {
+            if (b.has_try_entrance) {
+                merge_into(b.branch(), {-1, false});
+            }
+        }
+        for (auto i : IntRange(nlocals)) {
+            local_types[i] = arg_types.get(i);
+        }
+        merge_into(blocks[0], {-1, false});
+
+        while (worklist_head) {
+            auto &b = *static_cast<PyCodeBlock *>(worklist_head);
+            worklist_head = b.worklist_link;
+            b.worklist_link = &b;
+
+            size_t index = &b - blocks;
+            std::copy_n(block_input + index * nlocals, nlocals, local_types + 0);
+            IntVPC end_vpc = index + 1 < block_num ? blocks[index + 1].begin_vpc : py_code.instrNum();
+            auto narrowing = performTypeInference(b, end_vpc, py_code, stack, local_types, loaded_types);
+            if (b.fall_block) {
+                merge_into(b.fall(), narrowing.on_branch ? TypeNarrowing{-1, false} : narrowing);
+            }
+            if (b.branch_block && !b.has_try_entrance) {
+                merge_into(b.branch(), narrowing.on_branch ? narrowing : TypeNarrowing{-1, false});
+            }
+        }
+    }
+}
+
+InlinableBody InlinableBody::recognize(PyCode py_code) {
+    constexpr auto unsupported_flags = CO_VARARGS | CO_VARKEYWORDS |
+            CO_GENERATOR | CO_COROUTINE | CO_ITERABLE_COROUTINE | CO_ASYNC_GENERATOR;
+    if ((py_code->co_flags & (CO_OPTIMIZED | CO_NEWLOCALS | unsupported_flags)) != (CO_OPTIMIZED | CO_NEWLOCALS) ||
+            py_code->co_kwonlyargcount || PyTuple_GET_SIZE(py_code->co_cellvars) || PyTuple_GET_SIZE(py_code->co_freevars)) {
+        return {NONE};
+    }
+
+    auto instr = py_code.instrData();
+    PyOparg operand = _Py_OPARG(instr[0]);
+    auto loads_arg = _Py_OPCODE(instr[0]) == LOAD_FAST && operand < static_cast<PyOparg>(py_code->co_argcount);
+    switch (py_code.instrNum()) {
+    case 2:
+        if (_Py_OPCODE(instr[1]) != RETURN_VALUE) {
+            break;
+        }
+        if (loads_arg) {
+            return {RETURN_LOCAL, operand};
+        }
+        if (_Py_OPCODE(instr[0]) == LOAD_CONST) {
+            return {RETURN_CONST, operand};
+        }
+        break;
+    case 3:
+        if (loads_arg && _Py_OPCODE(instr[1]) == LOAD_ATTR && _Py_OPCODE(instr[2]) == RETURN_VALUE) {
+            return {RETURN_ATTR, operand, static_cast<PyOparg>(_Py_OPARG(instr[1]))};
+        }
+        break;
+    default:
+        break;
+    }
+    return {NONE};
+}
+
+constexpr bool hasTypedFastPath(int opcode) {
+    switch (opcode) {
+    case BINARY_ADD:
+    case INPLACE_ADD:
+    case BINARY_SUBTRACT:
+    case INPLACE_SUBTRACT:
+    case BINARY_MULTIPLY:
+    case INPLACE_MULTIPLY:
+    case BINARY_TRUE_DIVIDE:
+    case INPLACE_TRUE_DIVIDE:
+    case BINARY_SUBSCR:
+    case COMPARE_OP:
+    case POP_JUMP_IF_TRUE:
+    case POP_JUMP_IF_FALSE:
+    case JUMP_IF_TRUE_OR_POP:
+    case JUMP_IF_FALSE_OR_POP:
+        return true;
+    default:
+        return false;
+    }
+}
+
+unsigned ArgTypes::specializableArgs(PyCode py_code) {
+    constexpr auto generator_flags = CO_GENERATOR | CO_COROUTINE | CO_ITERABLE_COROUTINE | CO_ASYNC_GENERATOR;
+    if ((py_code->co_flags & (CO_OPTIMIZED | generator_flags)) != CO_OPTIMIZED) {
+        return 0;
+    }
+    auto arg_num = std::min<unsigned>(py_code->co_argcount + py_code->co_kwonlyargcount, max_arg_num);
+    unsigned mask = (1u << arg_num) - 1;
+
+    // Note: an argument keeps its type only if it is never rebound, and it is moved into a cell otherwise
+    if (py_code->co_cell2arg) {
+        for (auto i : IntRange(PyTuple_GET_SIZE(py_code->co_cellvars))) {
+            if (auto arg = py_code->co_cell2arg[i]; arg != CO_CELL_NOT_AN_ARG && arg < arg_num) {
+                mask &= ~(1u << arg);
+            }
+        }
+    }
+    // Note: a specialized version pays off only if an argument is soon consumed by an operation with a typed fast path,
+    //  so only the next two instructions after loading it are checked
+    unsigned used_mask = 0;
+    auto first_instr = py_code.instrData();
+    for (auto vpc : IntRange(py_code.instrNum())) {
+        auto opcode = _Py_OPCODE(first_instr[vpc]);
+        unsigned oparg = _Py_OPARG(first_instr[vpc]);
+        if ((opcode == STORE_FAST || opcode == DELETE_FAST) && oparg < arg_num) {
+            mask &= ~(1u << oparg);
+        } else if (opcode == LOAD_FAST && oparg < arg_num) {
+            for (auto next_vpc : IntRange(vpc + 1, std::min<IntVPC>(vpc + 3, py_code.instrNum()))) {
+                if (hasTypedFastPath(_Py_OPCODE(first_instr[next_vpc]))) {
+                    used_mask |= 1u << oparg;
+                }
+            }
+        }
+    }
+    return mask & used_mask;
 }
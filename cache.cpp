@@ -55,13 +55,17 @@ void BinCodeCache::setCacheRoot(const char *root) {
     }
 }
 
-BinCodeCache::BinCodeCache(PyCode py_code) : py_code{py_code} {
+BinCodeCache::BinCodeCache(PyCode py_code, ArgTypes arg_types) : py_code{py_code} {
     if (!cache_root.size()) {
         return;
     }
 
     instr_hash = llvm::hashing::detail::hash_short(
             reinterpret_cast<char *>(py_code.instrData()), py_code.instrSize(), HASH_SEED);
+    // Note: the translated code also depends on the types of constants, which the instructions do not tell
+    for (auto i : IntRange(PyTuple_GET_SIZE(py_code->co_consts))) {
+        instr_hash = llvm::hash_combine(instr_hash, classifyType(Py_TYPE(PyTuple_GET_ITEM(py_code->co_consts, i))));
+    }
 
     auto src_path_obj = PyUnicode_EncodeFSDefault(py_code->co_filename);
     if (!src_path_obj) {
@@ -98,6 +102,11 @@ BinCodeCache::BinCodeCache(PyCode py_code) : py_code{py_code} {
             cache_path.append("~anno");
         }
     }
+    if (arg_types) {
+        char signature[2 + 2 * sizeof(arg_types.bits)];
+        snprintf(signature, sizeof(signature), "~%x", arg_types.bits);
+        cache_path.append(signature);
+    }
     cache_path.append(BINARY_CACHE_SUFFIX);
 
     if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(cache_path))) {
@@ -1,3 +1,6 @@
+#include <Python.h>
+#include <longintrepr.h>
+
 #include "compilation_unit.h"
 
 using namespace llvm;
@@ -30,13 +33,26 @@ bool CompilationUnit::translate(PyObject *debug_args) {
     auto rt_code = loadFieldValue(frame_obj, &PyFrameObject::f_code, translator.tbaa_frame_field);
     rt_names = loadFieldValue(rt_code, &PyCodeObject::co_names, translator.tbaa_immutable);
     rt_consts = loadFieldValue(rt_code, &PyCodeObject::co_consts, translator.tbaa_immutable);
+    // Note: loop-invariant operands of the inline caches are loaded once per entry rather than per instruction
+    auto jit_result = loadFieldValue(cframe, &ExtendedCFrame::translated_result, translator.tbaa_immutable);
+    rt_opcache_arr = loadFieldValue(jit_result, &TranslatedResult::opcache_arr, translator.tbaa_immutable);
+    rt_globals = loadFieldValue(frame_obj, &PyFrameObject::f_globals, translator.tbaa_frame_field);
+    rt_builtins = loadFieldValue(frame_obj, &PyFrameObject::f_builtins, translator.tbaa_frame_field);
+    rt_builtins_is_dict = builder.CreateICmpEQ(
+            loadFieldValue(rt_builtins, &PyObject::ob_type, translator.tbaa_obj_field),
+            getSymbol<PyDict_Type>());
+    dispatch_block = createBlock(function, "dispatch");
+    builder.CreateBr(dispatch_block);
 
     for (auto &b : PtrRange(blocks, block_num)) {
         static_cast<BasicBlock *>(b)->insertInto(function);
         builder.SetInsertPoint(b);
-        stack_height = 0;
-        abstract_stack_top = abstract_stack;
-        declareStackGrowth(b.initial_stack_height);
+        if (!keep_abstract_stack) {
+            stack_height = 0;
+            abstract_stack_top = abstract_stack;
+            declareStackGrowth(b.initial_stack_height);
+        }
+        keep_abstract_stack = false;
         emitBlock(b, debug_info);
         assert(!b.fall_block || stack_height == b.fall().initial_stack_height);
     }
@@ -47,10 +63,11 @@ bool CompilationUnit::translate(PyObject *debug_args) {
         handler_pc_arr.reserve(handler_num);
         handler_vpc_arr.reserve(handler_num);
 
-        builder.SetInsertPoint(entry_block);
+        // Note: cframe->handler is rewritten by the runtime when an exception is caught
+        builder.SetInsertPoint(dispatch_block);
         auto indirect_jump = builder.CreateIndirectBr(builder.CreateInBoundsGEP(
                 translator.type<char>(), BlockAddress::get(function, blocks[0]),
-                loadFieldValue(cframe, &ExtendedCFrame::handler, translator.tbaa_immutable)
+                loadFieldValue(cframe, &ExtendedCFrame::handler, translator.tbaa_frame_field)
         ), 1 + handler_num);
         indirect_jump->addDestination(blocks[0]);
         unsigned count = 0;
@@ -76,8 +93,19 @@ bool CompilationUnit::translate(PyObject *debug_args) {
     if (unbound_error_block) {
         unbound_error_block->insertInto(function);
         builder.SetInsertPoint(unbound_error_block);
+        abstract_stack_top = instr_stack_top = abstract_stack;
         emitCall<raiseUnboundError>();
-        builder.CreateUnreachable();
+        builder.CreateBr(getErrorBlock());
+    }
+    if (error_block) {
+        error_block->insertInto(function);
+        builder.SetInsertPoint(error_block);
+        emitUnwindJump(emitCallImpl(handleError, getSymbol<handleError>()));
+    }
+    if (raise_block) {
+        raise_block->insertInto(function);
+        builder.SetInsertPoint(raise_block);
+        builder.CreateRet(translator.c_null);
     }
 
     debug_info.finalize(builder);
@@ -92,7 +120,7 @@ bool CompilationUnit::translate(PyObject *debug_args) {
 
 void CompilationUnit::pyIncRef(Value *py_obj) {
 #ifdef NON_INLINE_RC
-    emitCall<_Py_IncRef>(py_obj);
+    emitCallImpl(_Py_IncRef, getSymbol<_Py_IncRef>(), py_obj);
 #else
     Value *ref = py_obj;
     if constexpr (offsetof(PyObject, ob_refcnt)) {
@@ -109,7 +137,7 @@ void CompilationUnit::pyIncRef(Value *py_obj) {
 void CompilationUnit::pyDecRef(Value *py_obj, bool null_check) {
 #ifdef NON_INLINE_RC
     if (!null_check) {
-        emitCall<_Py_DecRef>(py_obj);
+        emitCallImpl(_Py_DecRef, getSymbol<_Py_DecRef>(), py_obj);
         return;
     }
 #endif
@@ -118,7 +146,7 @@ void CompilationUnit::pyDecRef(Value *py_obj, bool null_check) {
         emitUnlikelyJump(builder.CreateICmpEQ(py_obj, translator.c_null), b_end, "decref");
     }
 #ifdef NON_INLINE_RC
-    emitCall<_Py_DecRef>(py_obj);
+    emitCallImpl(_Py_DecRef, getSymbol<_Py_DecRef>(), py_obj);
 #else
     Value *ref = py_obj;
     if constexpr (offsetof(PyObject, ob_refcnt)) {
@@ -158,10 +186,9 @@ std::pair<Value *, Value *> CompilationUnit::getLocal(PyOparg oparg) {
     return {slot, value};
 }
 
-Value *CompilationUnit::getStackSlot(PyOparg i) {
-    assert(stack_height >= i);
+Value *CompilationUnit::getStackSlotAt(unsigned index) {
     auto offset = offsetof(PyFrameObject, f_localsplus) + sizeof(PyObject *) * (
-            stack_height - i +
+            index +
                     py_code->co_nlocals +
                     PyTuple_GET_SIZE(py_code->co_cellvars) +
                     PyTuple_GET_SIZE(py_code->co_freevars)
@@ -169,11 +196,25 @@ Value *CompilationUnit::getStackSlot(PyOparg i) {
     return calcElementAddr(frame_obj, offset);
 }
 
+Value *CompilationUnit::getStackSlot(PyOparg i) {
+    assert(stack_height >= i);
+    return getStackSlotAt(stack_height - i);
+}
+
 Value *CompilationUnit::fetchStackValue(PyOparg i) {
-    auto abs_v = abstract_stack_top[-i];
+    auto &abs_v = abstract_stack_top[-i];
     if (abs_v.on_stack()) {
-        return loadValue<PyObject *>(getStackSlot(stack_height - abs_v.index), translator.tbaa_frame_field,
+        if (abs_v.value) {
+            return abs_v.value;
+        }
+        assert(abs_v.spilled);
+        auto value = loadValue<PyObject *>(getStackSlotAt(abs_v.index), translator.tbaa_frame_field,
                 useName("stack$", abs_v.index, "$"));
+        // Note: a value loaded on a side path does not dominate the rest of the instruction
+        if (!on_side_path) {
+            abs_v.value = value;
+        }
+        return value;
     } else {
         if (abs_v.location == AbstractStackValue::LOCAL) {
             return getLocal(abs_v.index).second;
@@ -183,6 +224,52 @@ Value *CompilationUnit::fetchStackValue(PyOparg i) {
     }
 }
 
+void CompilationUnit::spillStack(AbstractStackValue *end, bool commit) {
+    for (auto &v : PtrRange(abstract_stack + 0, end - abstract_stack)) {
+        if (v.on_stack() && !v.spilled) {
+            auto value = v.value;
+            if (!v.owned) {
+                if (&v < abstract_stack_top) {
+                    pyIncRef(value);
+                    v.owned = commit;
+                } else {
+                    // Note: a borrowed operand is not released when unwinding the frame
+                    value = translator.c_null;
+                }
+            }
+            storeValue<PyObject *>(value, getStackSlotAt(v.index), translator.tbaa_frame_field);
+            v.spilled = commit;
+        }
+    }
+}
+
+bool CompilationUnit::takeOverLocalReference(PyOparg oparg) {
+    bool taken_over = false;
+    for (auto &v : PtrRange(abstract_stack + 0, abstract_stack_top - abstract_stack)) {
+        if (v.on_stack() && !v.owned && v.lender_local == static_cast<int>(oparg)) {
+            if (taken_over) {
+                pyIncRef(v.value);
+            }
+            v.owned = true;
+            taken_over = true;
+        }
+    }
+    return taken_over;
+}
+
+#ifndef NDEBUG
+void CompilationUnit::checkStackOwnership(bool at_block_end) {
+    for (auto &v : PtrRange(abstract_stack + 0, abstract_stack_top - abstract_stack)) {
+        if (v.on_stack()) {
+            assert(v.spilled || v.value);
+            assert(v.owned || (v.value && !v.spilled && v.lender_local >= -1
+                    && v.lender_local < py_code->co_nlocals));
+            assert(!at_block_end || (v.owned && v.spilled));
+        }
+    }
+}
+#endif
+
 Value *CompilationUnit::getName(PyOparg i) {
     return loadValue<PyObject *>(
             calcElementAddr(rt_names, offsetof(PyTupleObject, ob_item) + sizeof(PyObject *) * i),
@@ -208,29 +295,42 @@ void CompilationUnit::emitRotN(PyOparg n) {
     auto abs_top = abstract_stack_top[-1];
     auto top_really_pushed = abs_top.on_stack();
     decltype(n) n_lift = 0;
+    if (top_really_pushed) {
+        for (auto i : IntRange(1, n + 1)) {
+            if (abstract_stack_top[-i].on_stack()) {
+                n_lift += i != 1;
+                if (n_lift <= 8) {
+                    fetchStackValue(i);
+                }
+            }
+        }
+        if (n_lift > 8) {
+            spillStack();
+            emitCall<handle_ROT_N>(getStackSlot(n_lift + 1), n_lift);
+        }
+        abs_top = abstract_stack_top[-1];
+    }
+
     for (auto i : IntRange(1, n)) {
         auto &v = abstract_stack_top[-i] = abstract_stack_top[-(i + 1)];
         if (top_really_pushed && v.on_stack()) {
-            n_lift++;
             v.index++;
         }
     }
     abstract_stack_top[-n] = abs_top;
     abstract_stack_top[-n].index -= n_lift;
 
+    // Note: the values are moved in SSA registers, so their frame slots are out of date
     if (n_lift) {
-        if (n_lift <= 8) {
-            auto dest = getStackSlot(1);
-            auto top = loadValue<PyObject *>(dest, translator.tbaa_frame_field);
-            for (auto i : IntRange(n_lift)) {
-                auto src = getStackSlot(i + 2);
-                auto value = loadValue<PyObject *>(src, translator.tbaa_frame_field);
-                storeValue<PyObject *>(value, dest, translator.tbaa_frame_field);
-                dest = src;
+        for (auto &v : PtrRange(abstract_stack_top - n, n)) {
+            if (v.on_stack()) {
+                if (n_lift <= 8) {
+                    v.spilled = false;
+                } else {
+                    v.value = nullptr;
+                    v.spilled = true;
+                }
             }
-            storeValue<PyObject *>(top, dest, translator.tbaa_frame_field);
-        } else {
-            emitCall<handle_ROT_N>(getStackSlot(n_lift + 1), n_lift);
         }
     }
 }
@@ -247,10 +347,66 @@ void CompilationUnit::declareBlockAsHandler(PyCodeBlock &block) {
     }
 }
 
-void CompilationUnit::emitConditionalJump(Value *value, bool cond, BasicBlock *branch, BasicBlock *fall) {
+void CompilationUnit::checkUnboundError(Value *value) {
+    if (!unbound_error_block) {
+        unbound_error_block = createBlock(nullptr, "UnboundError");
+    }
+    auto error_block = unbound_error_block;
+    auto end = std::max(abstract_stack_top, instr_stack_top);
+    for (auto &v : PtrRange(abstract_stack + 0, end - abstract_stack)) {
+        if (v.on_stack() && !v.spilled) {
+            error_block = createBlock(function, "UnboundError.spill");
+            break;
+        }
+    }
+    emitUnlikelyJump(builder.CreateICmpEQ(value, translator.c_null), error_block, "load_ok");
+    if (error_block != unbound_error_block) {
+        auto ok_block = builder.GetInsertBlock();
+        builder.SetInsertPoint(error_block);
+        spillStack(end, false);
+        builder.CreateBr(unbound_error_block);
+        builder.SetInsertPoint(ok_block);
+    }
+}
+
+void CompilationUnit::emitConditionalJump(Value *value, bool cond, BasicBlock *branch, BasicBlock *fall,
+        KnownType type) {
     auto true_block = cond ? branch : fall;
     auto false_block = cond ? fall : branch;
 
+    if (value == bool_value) {
+        builder.CreateCondBr(bool_condition, true_block, false_block);
+        return;
+    }
+
+    // Note: test the truthiness of common builtin types inline by their sizes
+    const auto &emit_size_test = [&](BasicBlock *block, auto member) {
+        builder.SetInsertPoint(block);
+        auto size = loadFieldValue(value, member, translator.tbaa_obj_field);
+        builder.CreateCondBr(builder.CreateICmpNE(size, getConstantInt<Py_ssize_t>(0)), true_block, false_block);
+    };
+    switch (type) {
+    case KnownType::BOOL:
+        builder.CreateCondBr(builder.CreateICmpEQ(value, getSymbol<_Py_TrueStruct>()), true_block, false_block);
+        return;
+    case KnownType::INT:
+    case KnownType::TUPLE:
+    case KnownType::LIST:
+        emit_size_test(builder.GetInsertBlock(), &PyVarObject::ob_size);
+        return;
+    case KnownType::DICT:
+        emit_size_test(builder.GetInsertBlock(), &PyDictObject::ma_used);
+        return;
+    case KnownType::FLOAT:
+        builder.CreateCondBr(emitFloatIsNonzero(value), true_block, false_block);
+        return;
+    case KnownType::NONE:
+        builder.CreateBr(false_block);
+        return;
+    default:
+        break;
+    }
+
     auto fast_cmp_block = createBlock(function);
     auto slow_cmp_block = createBlock(function);
 
@@ -260,15 +416,287 @@ void CompilationUnit::emitConditionalJump(Value *value, bool cond, BasicBlock *b
     auto py_false = getSymbol<_Py_FalseStruct>();
     builder.CreateCondBr(builder.CreateICmpNE(value, py_false), slow_cmp_block, false_block, translator.unlikely);
     builder.SetInsertPoint(slow_cmp_block);
-    builder.CreateCondBr(emitCall<castPyObjectToBool>(value), true_block, false_block);
+
+    auto type_check_block = createBlock(function);
+    auto var_size_block = createBlock(function);
+    auto check_str_block = createBlock(function);
+    auto str_block = createBlock(function);
+    auto check_dict_block = createBlock(function);
+    auto dict_block = createBlock(function);
+    auto check_set_block = createBlock(function);
+    auto set_block = createBlock(function);
+    auto call_block = createBlock(function);
+    auto py_none = getSymbol<_Py_NoneStruct>();
+    builder.CreateCondBr(builder.CreateICmpEQ(value, py_none), false_block, type_check_block);
+    builder.SetInsertPoint(type_check_block);
+    auto ob_type = loadFieldValue(value, &PyObject::ob_type, translator.tbaa_obj_field);
+    auto is_var_size = builder.CreateOr(builder.CreateOr(
+            builder.CreateICmpEQ(ob_type, getSymbol<PyLong_Type>()),
+            builder.CreateICmpEQ(ob_type, getSymbol<PyList_Type>())),
+            builder.CreateICmpEQ(ob_type, getSymbol<PyTuple_Type>()));
+    builder.CreateCondBr(is_var_size, var_size_block, check_str_block);
+    emit_size_test(var_size_block, &PyVarObject::ob_size);
+    builder.SetInsertPoint(check_str_block);
+    builder.CreateCondBr(builder.CreateICmpEQ(ob_type, getSymbol<PyUnicode_Type>()), str_block, check_dict_block);
+    // Note: the length of a legacy str is not set until it is ready, so only a non-zero length is conclusive
+    builder.SetInsertPoint(str_block);
+    auto str_length = loadFieldValue(value, &PyASCIIObject::length, translator.tbaa_obj_field);
+    builder.CreateCondBr(builder.CreateICmpNE(str_length, getConstantInt<Py_ssize_t>(0)), true_block, call_block);
+    builder.SetInsertPoint(check_dict_block);
+    builder.CreateCondBr(builder.CreateICmpEQ(ob_type, getSymbol<PyDict_Type>()), dict_block, check_set_block);
+    emit_size_test(dict_block, &PyDictObject::ma_used);
+    builder.SetInsertPoint(check_set_block);
+    auto is_set = builder.CreateOr(
+            builder.CreateICmpEQ(ob_type, getSymbol<PySet_Type>()),
+            builder.CreateICmpEQ(ob_type, getSymbol<PyFrozenSet_Type>()));
+    builder.CreateCondBr(is_set, set_block, call_block);
+    emit_size_test(set_block, &PySetObject::used);
+
+    builder.SetInsertPoint(call_block);
+    on_side_path = true;
+    auto is_true = emitCall<castPyObjectToBool>(value);
+    builder.CreateCondBr(builder.CreateICmpNE(is_true, getConstantInt<int>(0)), true_block, false_block);
+    on_side_path = false;
+}
+
+KnownType inferUnaryResultType(int opcode, KnownType operand) {
+    switch (opcode) {
+    case UNARY_NOT:
+        return KnownType::BOOL;
+    case UNARY_POSITIVE:
+    case UNARY_NEGATIVE:
+        if (operand == KnownType::FLOAT) {
+            return KnownType::FLOAT;
+        }
+        [[fallthrough]];
+    case UNARY_INVERT:
+        return operand == KnownType::INT || operand == KnownType::BOOL ? KnownType::INT : KnownType::ANY;
+    default:
+        return KnownType::ANY;
+    }
+}
+
+KnownType inferBinaryResultType(int opcode, KnownType left, KnownType right) {
+    auto is_number = [](KnownType type) { return type == KnownType::INT || type == KnownType::FLOAT; };
+    auto is_sequence = [](KnownType type) {
+        return type == KnownType::STR || type == KnownType::TUPLE || type == KnownType::LIST;
+    };
+    auto is_scalar = [&](KnownType type) {
+        return is_number(type) || type == KnownType::BOOL || type == KnownType::STR;
+    };
+    switch (opcode) {
+    case BINARY_ADD:
+    case INPLACE_ADD:
+        if (left == right && is_sequence(left)) {
+            return left;
+        }
+        [[fallthrough]];
+    case BINARY_SUBTRACT:
+    case INPLACE_SUBTRACT:
+    case BINARY_FLOOR_DIVIDE:
+    case INPLACE_FLOOR_DIVIDE:
+    case BINARY_MODULO:
+    case INPLACE_MODULO:
+        if (left == KnownType::INT && right == KnownType::INT) {
+            return KnownType::INT;
+        }
+        return is_number(left) && is_number(right) ? KnownType::FLOAT : KnownType::ANY;
+    case BINARY_MULTIPLY:
+    case INPLACE_MULTIPLY:
+        if (is_sequence(left) && right == KnownType::INT) {
+            return left;
+        }
+        if (left == KnownType::INT && is_sequence(right)) {
+            return right;
+        }
+        if (left == KnownType::INT && right == KnownType::INT) {
+            return KnownType::INT;
+        }
+        return is_number(left) && is_number(right) ? KnownType::FLOAT : KnownType::ANY;
+    case BINARY_TRUE_DIVIDE:
+    case INPLACE_TRUE_DIVIDE:
+        return is_number(left) && is_number(right) ? KnownType::FLOAT : KnownType::ANY;
+    case BINARY_LSHIFT:
+    case INPLACE_LSHIFT:
+    case BINARY_RSHIFT:
+    case INPLACE_RSHIFT:
+    case BINARY_AND:
+    case INPLACE_AND:
+    case BINARY_OR:
+    case INPLACE_OR:
+    case BINARY_XOR:
+    case INPLACE_XOR:
+        return left == KnownType::INT && right == KnownType::INT ? KnownType::INT : KnownType::ANY;
+    case BINARY_SUBSCR:
+        return left == KnownType::STR && right == KnownType::INT ? KnownType::STR : KnownType::ANY;
+    case COMPARE_OP:
+        // Note: the rich comparisons of tuples and lists return whatever their items return
+        return is_scalar(left) && is_scalar(right) ? KnownType::BOOL : KnownType::ANY;
+    default:
+        return KnownType::ANY;
+    }
+}
+
+// Note: test the bits without the sign instead of comparing with 0.0,
+//  which would be materialized in a constant pool that the translated code cannot refer to
+Value *CompilationUnit::emitFloatIsNonzero(Value *py_float) {
+    auto bits = loadValue<uint64_t>(calcFieldAddr(py_float, &PyFloatObject::ob_fval), translator.tbaa_obj_field);
+    return builder.CreateICmpNE(builder.CreateShl(bits, getConstantInt<uint64_t>(1)), getConstantInt<uint64_t>(0));
+}
+
+// Note: an int of at most one digit has the value of the digit with the sign of ob_size.
+//  For zero, which may have no digit allocated, the digit is read from ob_size itself.
+std::pair<Value *, Value *> CompilationUnit::emitMediumIntValue(Value *py_int) {
+    auto size_addr = calcFieldAddr(py_int, &PyVarObject::ob_size);
+    auto size = loadValue<Py_ssize_t>(size_addr, translator.tbaa_obj_field);
+    auto is_medium = builder.CreateICmpULE(builder.CreateAdd(size, getConstantInt<Py_ssize_t>(1)),
+            getConstantInt<Py_ssize_t>(2));
+    auto digit_addr = builder.CreateSelect(builder.CreateICmpEQ(size, getConstantInt<Py_ssize_t>(0)),
+            size_addr, calcElementAddr(py_int, offsetof(PyLongObject, ob_digit)));
+    auto magnitude = builder.CreateZExt(loadValue<digit>(digit_addr, translator.tbaa_obj_field),
+            translator.type<long>());
+    auto value = builder.CreateSelect(builder.CreateICmpSLT(size, getConstantInt<Py_ssize_t>(0)),
+            builder.CreateNeg(magnitude), magnitude);
+    return {is_medium, value};
+}
+
+CompilationUnit::InlineResult CompilationUnit::emitInlineBinaryOperation(int opcode, PoppedValue &left,
+        PoppedValue &right) {
+    if (left.type == KnownType::FLOAT && right.type == KnownType::FLOAT) {
+        Instruction::BinaryOps op;
+        switch (opcode) {
+        case BINARY_ADD:
+        case INPLACE_ADD:
+            op = Instruction::FAdd;
+            break;
+        case BINARY_SUBTRACT:
+        case INPLACE_SUBTRACT:
+            op = Instruction::FSub;
+            break;
+        case BINARY_MULTIPLY:
+        case INPLACE_MULTIPLY:
+            op = Instruction::FMul;
+            break;
+        case BINARY_TRUE_DIVIDE:
+        case INPLACE_TRUE_DIVIDE:
+            op = Instruction::FDiv;
+            break;
+        default:
+            return {nullptr, nullptr};
+        }
+        auto l = loadFieldValue(left.value, &PyFloatObject::ob_fval, translator.tbaa_obj_field);
+        auto r = loadFieldValue(right.value, &PyFloatObject::ob_fval, translator.tbaa_obj_field);
+        BasicBlock *slow_block = nullptr;
+        // Note: the handler raises ZeroDivisionError
+        if (op == Instruction::FDiv) {
+            slow_block = createBlock(function, "float_divide.by_zero");
+            emitUnlikelyJump(builder.CreateNot(emitFloatIsNonzero(right.value)), slow_block, "float_divide.not_zero");
+        }
+        return {emitLeafCall<PyFloat_FromDouble>(builder.CreateBinOp(op, l, r)), slow_block};
+    }
+
+    if (left.type == KnownType::INT && right.type == KnownType::INT) {
+        Instruction::BinaryOps op;
+        switch (opcode) {
+        case BINARY_ADD:
+        case INPLACE_ADD:
+            op = Instruction::Add;
+            break;
+        case BINARY_SUBTRACT:
+        case INPLACE_SUBTRACT:
+            op = Instruction::Sub;
+            break;
+        case BINARY_MULTIPLY:
+        case INPLACE_MULTIPLY:
+            op = Instruction::Mul;
+            break;
+        default:
+            return {nullptr, nullptr};
+        }
+        auto [l_is_medium, l] = emitMediumIntValue(left.value);
+        auto [r_is_medium, r] = emitMediumIntValue(right.value);
+        auto slow_block = createBlock(function, "int_operation.slow");
+        emitUnlikelyJump(builder.CreateNot(builder.CreateAnd(l_is_medium, r_is_medium)),
+                slow_block, "int_operation.medium");
+        // Note: the operands have at most 30 bits, so the result never overflows
+        return {emitLeafCall<PyLong_FromLong>(builder.CreateBinOp(op, l, r)), slow_block};
+    }
+
+    if (opcode == BINARY_SUBSCR && right.type == KnownType::INT
+            && (left.type == KnownType::LIST || left.type == KnownType::TUPLE)) {
+        auto [is_medium, index] = emitMediumIntValue(right.value);
+        auto size = loadFieldValue(left.value, &PyVarObject::ob_size, translator.tbaa_obj_field);
+        index = builder.CreateSelect(builder.CreateICmpSLT(index, getConstantInt<Py_ssize_t>(0)),
+                builder.CreateAdd(index, size), index);
+        auto slow_block = createBlock(function, "subscr.slow");
+        emitUnlikelyJump(builder.CreateNot(builder.CreateAnd(is_medium, builder.CreateICmpULT(index, size))),
+                slow_block, "subscr.in_range");
+        auto items = left.type == KnownType::LIST ?
+                loadFieldValue(left.value, &PyListObject::ob_item, translator.tbaa_obj_field) :
+                calcElementAddr(left.value, offsetof(PyTupleObject, ob_item));
+        auto item = loadValue<PyObject *>(builder.CreateInBoundsGEP(translator.type<PyObject *>(), items, index),
+                translator.tbaa_obj_field);
+        pyIncRef(item);
+        return {item, slow_block};
+    }
+    return {nullptr, nullptr};
+}
+
+Value *CompilationUnit::emitInlineComparison(int op, PoppedValue &left, PoppedValue &right) {
+    // Note: NaN compares unequal to everything, as float_richcompare does
+    static constexpr CmpInst::Predicate float_predicates[]{
+            CmpInst::FCMP_OLT, CmpInst::FCMP_OLE, CmpInst::FCMP_OEQ,
+            CmpInst::FCMP_UNE, CmpInst::FCMP_OGT, CmpInst::FCMP_OGE
+    };
+    static constexpr CmpInst::Predicate int_predicates[]{
+            CmpInst::ICMP_SLT, CmpInst::ICMP_SLE, CmpInst::ICMP_EQ,
+            CmpInst::ICMP_NE, CmpInst::ICMP_SGT, CmpInst::ICMP_SGE
+    };
+    static_assert(Py_LT == 0 && Py_LE == 1 && Py_EQ == 2 && Py_NE == 3 && Py_GT == 4 && Py_GE == 5);
+
+    if (left.type == KnownType::FLOAT && right.type == KnownType::FLOAT) {
+        auto l = loadFieldValue(left.value, &PyFloatObject::ob_fval, translator.tbaa_obj_field);
+        auto r = loadFieldValue(right.value, &PyFloatObject::ob_fval, translator.tbaa_obj_field);
+        return builder.CreateFCmp(float_predicates[op], l, r);
+    }
+
+    if (left.type == KnownType::INT && right.type == KnownType::INT) {
+        auto [l_is_medium, l] = emitMediumIntValue(left.value);
+        auto [r_is_medium, r] = emitMediumIntValue(right.value);
+        auto slow_block = createBlock(function, "int_compare.slow");
+        emitUnlikelyJump(builder.CreateNot(builder.CreateAnd(l_is_medium, r_is_medium)),
+                slow_block, "int_compare.medium");
+        auto fast_cond = builder.CreateICmp(int_predicates[op], l, r);
+        auto fast_end = builder.GetInsertBlock();
+        auto end_block = createBlock(function, "int_compare.end");
+        builder.CreateBr(end_block);
+
+        // Note: comparing two ints always gives a bool
+        builder.SetInsertPoint(slow_block);
+        on_side_path = true;
+        auto res = emitCall<handle_COMPARE_OP>(left, right, op);
+        on_side_path = false;
+        auto slow_cond = builder.CreateICmpEQ(res, getSymbol<_Py_TrueStruct>());
+        pyDecRef(res);
+        auto slow_end = builder.GetInsertBlock();
+        builder.CreateBr(end_block);
+
+        builder.SetInsertPoint(end_block);
+        auto cond = builder.CreatePHI(translator.type<bool>(), 2);
+        cond->addIncoming(fast_cond, fast_end);
+        cond->addIncoming(slow_cond, slow_end);
+        return cond;
+    }
+    return nullptr;
 }
 
 void CompilationUnit::emitCheckEvalBreaker(IntVPC next_vpc) {
     auto next_opcode = _Py_OPCODE(py_code.instrData()[next_vpc]);
-    if (next_opcode != SETUP_FINALLY
-            && next_opcode != SETUP_WITH
-            && next_opcode != BEFORE_ASYNC_WITH
-            && next_opcode != YIELD_FROM) {
+    // Note: same as CPython, never handle pending calls right before these opcodes
+    if (next_opcode == SETUP_FINALLY
+            || next_opcode == SETUP_WITH
+            || next_opcode == BEFORE_ASYNC_WITH
+            || next_opcode == YIELD_FROM) {
         return;
     }
 
@@ -289,8 +717,35 @@ void CompilationUnit::emitCheckEvalBreaker(IntVPC next_vpc) {
     // the number of elements in the stack can be correctly known
     // when an error occurs in handleEvalBreaker.
     storeFieldValue(next_vpc, frame_obj, &PyFrameObject::f_lasti, translator.tbaa_frame_field);
+    on_side_path = true;
+    spillStack(abstract_stack_top, false);
     emitCall<handleEvalBreaker>();
+    on_side_path = false;
     builder.CreateBr(end_block);
     builder.SetInsertPoint(end_block);
 }
 
+void CompilationUnit::emitSafepoint(IntVPC next_vpc, IntVPC jump_vpc, Value *jump_cond) {
+    auto countdown = builder.CreateSub(
+            loadFieldValue(cframe, &ExtendedCFrame::safepoint_countdown, translator.tbaa_frame_field),
+            getConstantInt<int>(1));
+    storeFieldValue(countdown, cframe, &ExtendedCFrame::safepoint_countdown, translator.tbaa_frame_field);
+    // Note: not marked as unlikely, since the default interval polls on every back-edge
+    auto poll_block = createBlock(function, "safepoint.poll");
+    auto end_block = createBlock(function, "safepoint.end");
+    builder.CreateCondBr(builder.CreateICmpSLE(countdown, getConstantInt<int>(0)), poll_block, end_block);
+    builder.SetInsertPoint(poll_block);
+    auto interval = loadValue<int>(getSymbol<safepoint_interval>(), translator.tbaa_immutable);
+    storeFieldValue(interval, cframe, &ExtendedCFrame::safepoint_countdown, translator.tbaa_frame_field);
+    emitCheckEvalBreaker(next_vpc);
+    // Note: the translated code does not trace, so the frame continues in the interpreter once tracing is enabled.
+    //  It resumes at the jump itself, so that the interpreter reports the backward edge to the trace function.
+    auto deopt_block = createBlock(function, "safepoint.deopt");
+    auto use_tracing = loadFieldValue(cframe, &ExtendedCFrame::use_tracing, translator.tbaa_frame_field);
+    builder.CreateCondBr(builder.CreateICmpNE(use_tracing, getConstantInt<int>(0)), deopt_block, end_block,
+            translator.unlikely);
+    builder.SetInsertPoint(deopt_block);
+    emitDeoptimization(jump_vpc, jump_cond);
+    builder.SetInsertPoint(end_block);
+}
+
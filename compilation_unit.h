@@ -57,6 +57,9 @@ decltype(auto) useName(const T &arg, const Ts &... more) {
 #define useName(...) empty_twine
 #endif
 
+KnownType inferUnaryResultType(int opcode, KnownType operand);
+KnownType inferBinaryResultType(int opcode, KnownType left, KnownType right);
+
 struct PyAnalysisBlock {
     BitArray locals_touched;
     BitArray locals_set;
@@ -83,6 +86,7 @@ struct PyCodeBlock : PyAnalysisBlock {
     int initial_stack_height;
     int stack_effect;
     int branch_stack_difference;
+    unsigned predecessor_num;
     bool has_try_entrance;
     bool has_try_exit;
 
@@ -106,19 +110,32 @@ class CompilationUnit {
         enum Location { STACK, LOCAL, CONST };
         Location location;
         unsigned index;
+        // Note: A value really pushed lives in an SSA register,
+        // and it is written to its frame slot only when someone may read it from there.
+        llvm::Value *value;
+        bool spilled;
+        // Note: A value pushed by LOAD_FAST borrows the reference of the local variable,
+        // until the local variable is overwritten or the value escapes into the frame.
+        // Constants and singletons outlive the code object, so they are borrowed without a lender.
+        bool owned;
+        int lender_local;
+        KnownType type;
 
         bool on_stack() const { return location == STACK; }
 
         AbstractStackValue() = default;
 
-        AbstractStackValue(Location location, auto index) : location{location}, index(index) {}
+        AbstractStackValue(Location location, auto index) :
+                location{location}, index(index), value{nullptr}, spilled{true}, owned{true}, lender_local{-1},
+                type{KnownType::ANY} {}
     };
 
     struct PoppedValue {
         llvm::Value *const value;
         const bool really_pushed;
+        const KnownType type;
 
-        PoppedValue(llvm::Value *v, bool p) : value{v}, really_pushed(p) {}
+        PoppedValue(llvm::Value *v, bool p, KnownType t = KnownType::ANY) : value{v}, really_pushed(p), type{t} {}
 
         operator llvm::Value *() { return value; }
     };
@@ -131,25 +148,40 @@ class CompilationUnit {
     llvm::Argument *frame_obj;
     llvm::Argument *cframe;
     llvm::Argument *eval_breaker;
+    llvm::BasicBlock *dispatch_block;
+    llvm::BasicBlock *error_block{nullptr};
+    llvm::BasicBlock *raise_block{nullptr};
     llvm::BasicBlock *unbound_error_block{nullptr};
 
     PyCode py_code;
+    ArgTypes arg_types;
     unsigned block_num;
     DynamicArray<PyCodeBlock> blocks;
     std::unique_ptr<BitArray::ChunkType> analysis_data;
     BitArray redundant_loads;
+    // Note: the exact type of the local variable loaded by each LOAD_FAST, if it is known
+    DynamicArray<KnownType> loaded_types;
     unsigned opcache_count{0};
     unsigned handler_num{0};
     DynamicArray<IntVPC> handler_vpc_arr;
 
     llvm::Value *rt_names;
     llvm::Value *rt_consts;
+    llvm::Value *rt_opcache_arr;
+    llvm::Value *rt_globals;
+    llvm::Value *rt_builtins;
+    llvm::Value *rt_builtins_is_dict;
 
     int stack_height;
     DynamicArray<uint_least16_t> stack_height_arr;
 
     DynamicArray<AbstractStackValue> abstract_stack;
     AbstractStackValue *abstract_stack_top;
+    AbstractStackValue *instr_stack_top;
+    bool on_side_path{false};
+    llvm::Value *bool_value{nullptr};
+    llvm::Value *bool_condition{nullptr};
+    bool keep_abstract_stack{false};
 
     void parsePyCode();
     void emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info);
@@ -159,24 +191,60 @@ class CompilationUnit {
     std::pair<llvm::Value *, llvm::Value *> getLocal(PyOparg oparg);
     llvm::Value *getName(PyOparg i);
     llvm::Value *getFreevar(PyOparg i);
+    llvm::Value *getStackSlotAt(unsigned index);
     llvm::Value *getStackSlot(PyOparg i = 0);
     llvm::Value *fetchStackValue(PyOparg i);
+    void spillStack(AbstractStackValue *end, bool commit = true);
+
+    void spillStack() { spillStack(abstract_stack_top); }
+
+    // Note: Operands popped by the current instruction are still owned by the frame if an error occurs
+    void spillStackForCall() { spillStack(std::max(abstract_stack_top, instr_stack_top), !on_side_path); }
 
     PoppedValue pyPop() {
         auto abs_v = *--abstract_stack_top;
-        auto really_pushed = abs_v.on_stack();
-        stack_height -= really_pushed;
-        return {fetchStackValue(0), really_pushed};
+        stack_height -= abs_v.on_stack();
+        return {fetchStackValue(0), abs_v.on_stack() && abs_v.owned, abs_v.type};
     }
 
-    void pyPush(llvm::Value *value) {
+    void pyPush(llvm::Value *value, bool owned = true, int lender_local = -1) {
         auto &stack_value = *abstract_stack_top++;
         stack_value.location = AbstractStackValue::STACK;
-        stack_value.index = stack_height;
-        storeValue<PyObject *>(value, getStackSlot(), translator.tbaa_frame_field);
-        stack_height++;
+        stack_value.index = stack_height++;
+        stack_value.value = value;
+        stack_value.spilled = false;
+        stack_value.owned = owned;
+        stack_value.lender_local = lender_local;
+        stack_value.type = KnownType::ANY;
+    }
+
+    void declareTopType(KnownType type) { abstract_stack_top[-1].type = type; }
+
+    void pyPushBorrowed(llvm::Value *value, int lender_local = -1) { pyPush(value, false, lender_local); }
+
+    // Note: remember the condition, so that a following conditional jump can branch on it directly
+    void pyPushBool(llvm::Value *cond) {
+        auto py_true = getSymbol<_Py_TrueStruct>();
+        auto py_false = getSymbol<_Py_FalseStruct>();
+        bool_value = builder.CreateSelect(cond, py_true, py_false);
+        bool_condition = cond;
+        pyPushBorrowed(bool_value);
+        declareTopType(KnownType::BOOL);
+    }
+
+    void ownStackValue(AbstractStackValue &v) {
+        if (v.on_stack() && !v.owned) {
+            pyIncRef(v.value);
+            v.owned = true;
+        }
     }
 
+    bool takeOverLocalReference(PyOparg oparg);
+
+#ifndef NDEBUG
+    void checkStackOwnership(bool at_block_end);
+#endif
+
     void declareStackGrowth(PyOparg n) {
         for ([[maybe_unused]] auto _ : IntRange(n)) {
             *abstract_stack_top++ = {AbstractStackValue::STACK, stack_height++};
@@ -186,11 +254,10 @@ class CompilationUnit {
     llvm::Value *declareStackShrink(PyOparg n) {
         abstract_stack_top -= n;
         stack_height -= n;
-#ifndef NDEBUG
         for (auto &v : PtrRange(abstract_stack_top, n)) {
             assert(v.on_stack());
+            ownStackValue(v);
         }
-#endif
         return getStackSlot();
     }
 
@@ -259,7 +326,22 @@ class CompilationUnit {
         return storeValue<M>(value, calcFieldAddr(instance, member), tbaa);
     }
 
+    // Note: an extra value can be pushed for the interpreter, e.g. the condition of a jump to be re-executed
+    void emitDeoptimization(IntVPC resume_vpc, llvm::Value *extra_value = nullptr) {
+        spillStack(abstract_stack_top, false);
+        auto depth = stack_height;
+        if (extra_value) {
+            pyIncRef(extra_value);
+            storeValue<PyObject *>(extra_value, getStackSlotAt(depth++), translator.tbaa_frame_field);
+        }
+        storeFieldValue(static_cast<int>(resume_vpc) - 1, frame_obj, &PyFrameObject::f_lasti,
+                translator.tbaa_frame_field);
+        storeFieldValue(depth, frame_obj, &PyFrameObject::f_stackdepth, translator.tbaa_frame_field);
+        builder.CreateRet(getSymbol<deoptimized_frame>());
+    }
+
     void returnFrame(PyFrameState state, llvm::Value *retval) {
+        spillStack(abstract_stack_top, false);
         storeFieldValue(state, frame_obj, &PyFrameObject::f_state, translator.tbaa_frame_field);
         storeFieldValue(stack_height, frame_obj, &PyFrameObject::f_stackdepth, translator.tbaa_frame_field);
         builder.CreateRet(retval);
@@ -270,8 +352,62 @@ class CompilationUnit {
         return builder.CreateCall(translator.type<Ret(Args...)>(), callee, {getValueAuto<Args>(args)...});
     }
 
+    template <typename Ret, typename... Args>
+    static Ret returnTypeOf(Ret (&)(Args...));
+
+    // Note: A handler returning PyObject * or int reports an exception by returning NULL or a negative value,
+    // which is checked here and leads to the error block.
     template <auto &Symbol>
-    auto emitCall(auto &&... args) { return emitCallImpl(Symbol, getSymbol<Symbol>(), args...); }
+    auto emitCall(auto &&... args) {
+        spillStackForCall();
+        auto result = emitCallImpl(Symbol, getSymbol<Symbol>(), args...);
+        using Ret = decltype(returnTypeOf(Symbol));
+        if constexpr (std::is_same_v<Ret, PyObject *>) {
+            emitUnlikelyJump(builder.CreateICmpEQ(result, translator.c_null), getErrorBlock(), "no_error");
+        } else if constexpr (std::is_same_v<Ret, int>) {
+            emitUnlikelyJump(builder.CreateICmpSLT(result, getConstantInt<int>(0)), getErrorBlock(), "no_error");
+        }
+        return result;
+    }
+
+    // Note: A leaf function never needs the value stack of this frame,
+    // so the stack is spilled only when it fails and leads to the error block.
+    template <auto &Symbol>
+    auto emitLeafCall(auto &&... args) {
+        static_assert(std::is_same_v<decltype(returnTypeOf(Symbol)), PyObject *>);
+        auto result = emitCallImpl(Symbol, getSymbol<Symbol>(), args...);
+        auto spill_block = createBlock(function, "leaf_call.error");
+        emitUnlikelyJump(builder.CreateICmpEQ(result, translator.c_null), spill_block, "no_error");
+        auto fall_block = builder.GetInsertBlock();
+        builder.SetInsertPoint(spill_block);
+        auto was_on_side_path = on_side_path;
+        on_side_path = true;
+        spillStackForCall();
+        on_side_path = was_on_side_path;
+        builder.CreateBr(getErrorBlock());
+        builder.SetInsertPoint(fall_block);
+        return result;
+    }
+
+    llvm::BasicBlock *getErrorBlock() {
+        if (!error_block) {
+            error_block = createBlock(nullptr, "error");
+        }
+        return error_block;
+    }
+
+    // Note: If the runtime finds an exception handler in this frame, it leaves the handler in cframe->handler
+    void emitUnwindJump(llvm::Value *handler_found) {
+        if (!raise_block) {
+            raise_block = createBlock(nullptr, "raise");
+        }
+        builder.CreateCondBr(handler_found, dispatch_block, raise_block);
+    }
+
+    template <auto &Symbol>
+    void emitRaise(auto &&... args) {
+        emitUnwindJump(emitCall<Symbol>(args...));
+    }
 
     void declareBlockAsHandler(PyCodeBlock &block);
 
@@ -281,37 +417,67 @@ class CompilationUnit {
         builder.SetInsertPoint(fall_block);
     }
 
-    void checkUnboundError(llvm::Value *value) {
-        if (!unbound_error_block) {
-            unbound_error_block = createBlock(nullptr, "UnboundError");
-        }
-        emitUnlikelyJump(builder.CreateICmpEQ(value, translator.c_null), unbound_error_block, "load_ok");
-    }
+    void checkUnboundError(llvm::Value *value);
 
-    void emitConditionalJump(llvm::Value *value, bool cond, llvm::BasicBlock *branch, llvm::BasicBlock *fall);
+    void emitConditionalJump(llvm::Value *value, bool cond, llvm::BasicBlock *branch, llvm::BasicBlock *fall,
+            KnownType type = KnownType::ANY);
 
     template <PyObject *(&Symbol)(PyObject *)>
-    void emitUnaryOperation() {
+    void emitUnaryOperation(int opcode) {
         auto value = pyPop();
         auto res = emitCall<Symbol>(value);
         pyPush(res);
+        declareTopType(inferUnaryResultType(opcode, value.type));
         pyDecRef(value);
     }
 
+    // Note: the inline path of an operation leaves the cases it cannot handle to slow_block, if any
+    struct InlineResult {
+        llvm::Value *value;
+        llvm::BasicBlock *slow_block;
+    };
+
+    llvm::Value *emitFloatIsNonzero(llvm::Value *py_float);
+    std::pair<llvm::Value *, llvm::Value *> emitMediumIntValue(llvm::Value *py_int);
+    InlineResult emitInlineBinaryOperation(int opcode, PoppedValue &left, PoppedValue &right);
+    llvm::Value *emitInlineComparison(int op, PoppedValue &left, PoppedValue &right);
+
     template <PyObject *(&Symbol)(PyObject *, PyObject *)>
-    void emitBinaryOperation() {
+    void emitBinaryOperation(int opcode) {
         auto right = pyPop();
         auto left = pyPop();
-        auto res = emitCall<Symbol>(left, right);
+        auto [res, slow_block] = emitInlineBinaryOperation(opcode, left, right);
+        if (!res) {
+            res = emitCall<Symbol>(left, right);
+        } else if (slow_block) {
+            auto fast_end = builder.GetInsertBlock();
+            auto end_block = createBlock(function);
+            builder.CreateBr(end_block);
+            builder.SetInsertPoint(slow_block);
+            on_side_path = true;
+            auto slow_res = emitCall<Symbol>(left, right);
+            on_side_path = false;
+            auto slow_end = builder.GetInsertBlock();
+            builder.CreateBr(end_block);
+            builder.SetInsertPoint(end_block);
+            auto phi = builder.CreatePHI(translator.type<PyObject *>(), 2);
+            phi->addIncoming(res, fast_end);
+            phi->addIncoming(slow_res, slow_end);
+            res = phi;
+        }
         pyPush(res);
+        declareTopType(inferBinaryResultType(opcode, left.type, right.type));
         pyDecRef(left);
         pyDecRef(right);
     }
 
     void emitCheckEvalBreaker(IntVPC next_vpc);
 
+    void emitSafepoint(IntVPC next_vpc, IntVPC jump_vpc, llvm::Value *jump_cond = nullptr);
+
 public:
-    explicit CompilationUnit(Translator &translator, PyCode py_code) : translator{translator}, py_code{py_code} {};
+    explicit CompilationUnit(Translator &translator, PyCode py_code, ArgTypes arg_types) :
+            translator{translator}, py_code{py_code}, arg_types{arg_types} {};
     bool translate(PyObject *debug_args);
 };
 
@@ -328,7 +494,11 @@ public:
     };
 private:
     static constexpr char BINARY_CACHE_SUFFIX[]{".compyler-310.bin"};
-    static constexpr uint64_t HASH_SEED{310};
+    // Note: bump CODE_VERSION whenever the translated code changes its ABI with the runtime,
+    // adding runtime symbols is taken into account automatically
+    static constexpr uint64_t CODE_VERSION{2};
+    static constexpr uint64_t HASH_SEED{310 ^ CODE_VERSION << 16
+            ^ std::tuple_size_v<RuntimeSymbols::SymbolTypes> << 32};
 
     inline static llvm::SmallString<512> cache_root;
 
@@ -343,7 +513,7 @@ private:
     bool isCacheEnabled() { return fd != -1; }
 
 public:
-    BinCodeCache(PyCode py_code);
+    BinCodeCache(PyCode py_code, ArgTypes arg_types);
     ~BinCodeCache();
     TranslatedResult *load();
     TranslatedResult *store(CompilationUnit &cu);
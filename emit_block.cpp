@@ -1,4 +1,5 @@
 #include "compilation_unit.h"
+#include "ported/interface.h"
 
 using namespace llvm;
 
@@ -14,6 +15,10 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         // Note: Python/compile.c sets MAX_ALLOWED_STACK_USE to 3000
         assert(stack_height >= 0 && stack_height <= UINT_LEAST16_MAX);
         stack_height_arr[vpc] = stack_height;
+        instr_stack_top = abstract_stack_top;
+#ifndef NDEBUG
+        checkStackOwnership(false);
+#endif
         auto opcode = _Py_OPCODE(py_code.instrData()[vpc]);
         auto oparg = _Py_OPARG(py_code.instrData()[vpc]) | extended_oparg;
         extended_oparg = 0;
@@ -47,8 +52,13 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             auto top = abstract_stack_top[-1];
             if (top.on_stack()) {
                 auto value = fetchStackValue(1);
-                pyIncRef(value);
-                pyPush(value);
+                if (top.owned) {
+                    pyIncRef(value);
+                    pyPush(value);
+                } else {
+                    pyPushBorrowed(value, top.lender_local);
+                }
+                declareTopType(top.type);
             } else {
                 *abstract_stack_top++ = top;
             }
@@ -58,16 +68,26 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             auto second = abstract_stack_top[-2];
             if (second.on_stack()) {
                 auto value = fetchStackValue(2);
-                pyIncRef(value);
-                pyPush(value);
+                if (second.owned) {
+                    pyIncRef(value);
+                    pyPush(value);
+                } else {
+                    pyPushBorrowed(value, second.lender_local);
+                }
+                declareTopType(second.type);
             } else {
                 *abstract_stack_top++ = second;
             }
             auto top = abstract_stack_top[-2];
             if (top.on_stack()) {
                 auto value = fetchStackValue(2);
-                pyIncRef(value);
-                pyPush(value);
+                if (top.owned) {
+                    pyIncRef(value);
+                    pyPush(value);
+                } else {
+                    pyPushBorrowed(value, top.lender_local);
+                }
+                declareTopType(top.type);
             } else {
                 *abstract_stack_top++ = top;
             }
@@ -83,9 +103,9 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             if (with_SOE && redundant_loads.get(vpc)) {
                 *abstract_stack_top++ = {AbstractStackValue::CONST, oparg};
             } else {
-                pyPush(value);
-                pyIncRef(value);
+                pyPushBorrowed(value);
             }
+            declareTopType(classifyType(Py_TYPE(PyTuple_GET_ITEM(py_code->co_consts, oparg))));
             break;
         }
         case LOAD_FAST: {
@@ -96,9 +116,9 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             if (with_SOE && redundant_loads.get(vpc)) {
                 *abstract_stack_top++ = {AbstractStackValue::LOCAL, oparg};
             } else {
-                pyPush(value);
-                pyIncRef(value);
+                pyPushBorrowed(value, oparg);
             }
+            declareTopType(loaded_types[vpc]);
             defined_locals.set(oparg);
             break;
         }
@@ -109,7 +129,9 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
                 pyIncRef(value);
             }
             storeValue<PyObject *>(value, slot, translator.tbaa_frame_field);
-            pyDecRef(old_value, !with_ICE || !defined_locals.get(oparg));
+            if (!takeOverLocalReference(oparg)) {
+                pyDecRef(old_value, !with_ICE || !defined_locals.get(oparg));
+            }
             defined_locals.set(oparg);
             break;
         }
@@ -119,7 +141,9 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
                 checkUnboundError(old_value);
             }
             storeValue<PyObject *>(translator.c_null, slot, translator.tbaa_frame_field);
-            pyDecRef(old_value);
+            if (!takeOverLocalReference(oparg)) {
+                pyDecRef(old_value);
+            }
             defined_locals.reset(oparg);
             break;
         }
@@ -158,10 +182,75 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             break;
         }
         case LOAD_GLOBAL: {
-            auto jit_result = loadFieldValue(cframe, &ExtendedCFrame::translated_result, translator.tbaa_immutable);
-            auto opcache_arr = loadFieldValue(jit_result, &TranslatedResult::opcache_arr, translator.tbaa_immutable);
-            auto opcache_ptr = calcElementAddr<_PyOpcache>(opcache_arr, opcache_count++);
-            auto value = emitCall<handle_LOAD_GLOBAL>(frame_obj, getName(oparg), opcache_ptr);
+            // Note: optimized is 2 when the opcache holds the globals keys, the entry offset and the keys size,
+            //  and 1 when it holds the value with dict versions, which is never filled for non-dict builtins
+            auto opcache_ptr = calcElementAddr<_PyOpcache>(rt_opcache_arr, opcache_count++);
+            auto b_entry = createBlock(function, "LOAD_GLOBAL.entry");
+            auto b_entry_size = createBlock(function, "LOAD_GLOBAL.entry_size");
+            auto b_entry_key = createBlock(function, "LOAD_GLOBAL.entry_key");
+            auto b_entry_hit = createBlock(function, "LOAD_GLOBAL.entry_hit");
+            auto b_version = createBlock(function, "LOAD_GLOBAL.version");
+            auto b_check = createBlock(function, "LOAD_GLOBAL.check");
+            auto b_hit = createBlock(function, "LOAD_GLOBAL.hit");
+            auto b_miss = createBlock(function, "LOAD_GLOBAL.miss");
+            auto b_end = createBlock(function, "LOAD_GLOBAL.end");
+            auto optimized = loadFieldValue(opcache_ptr, &_PyOpcache::optimized, translator.tbaa_obj_field);
+            builder.CreateCondBr(builder.CreateICmpEQ(optimized, getConstantInt<char>(2)), b_entry, b_version);
+
+            builder.SetInsertPoint(b_entry);
+            auto keys = loadFieldValue(opcache_ptr, &_PyOpcache_LoadGlobal::ptr, translator.tbaa_obj_field);
+            auto globals_keys = loadFieldValue(rt_globals, &PyDictObject::ma_keys, translator.tbaa_obj_field);
+            builder.CreateCondBr(builder.CreateICmpEQ(keys, globals_keys), b_entry_size, b_miss);
+            builder.SetInsertPoint(b_entry_size);
+            auto keys_size = loadValue<Py_ssize_t>(calcElementAddr<char>(keys, dict_keys_size_offset),
+                    translator.tbaa_obj_field);
+            auto cached_size = loadFieldValue(opcache_ptr, &_PyOpcache_LoadGlobal::builtins_ver,
+                    translator.tbaa_obj_field);
+            builder.CreateCondBr(builder.CreateICmpEQ(keys_size, cached_size), b_entry_key, b_miss);
+            builder.SetInsertPoint(b_entry_key);
+            auto entry_offset = loadFieldValue(opcache_ptr, &_PyOpcache_LoadGlobal::globals_ver,
+                    translator.tbaa_obj_field);
+            auto entry = builder.CreateInBoundsGEP(translator.type<char>(), keys, entry_offset);
+            auto entry_key = loadValue<PyObject *>(calcElementAddr<char>(entry, dict_entry_key_offset),
+                    translator.tbaa_obj_field);
+            auto entry_value = loadValue<PyObject *>(calcElementAddr<char>(entry, dict_entry_value_offset),
+                    translator.tbaa_obj_field);
+            builder.CreateCondBr(builder.CreateAnd(builder.CreateICmpEQ(entry_key, getName(oparg)),
+                    builder.CreateICmpNE(entry_value, translator.c_null)), b_entry_hit, b_miss);
+            builder.SetInsertPoint(b_entry_hit);
+            pyIncRef(entry_value);
+            auto b_entry_hit_end = builder.GetInsertBlock();
+            builder.CreateBr(b_end);
+
+            builder.SetInsertPoint(b_version);
+            builder.CreateCondBr(builder.CreateAnd(builder.CreateICmpEQ(optimized, getConstantInt<char>(1)),
+                    rt_builtins_is_dict), b_check, b_miss);
+            builder.SetInsertPoint(b_check);
+            auto lg_globals_ver = loadFieldValue(opcache_ptr, &_PyOpcache_LoadGlobal::globals_ver,
+                    translator.tbaa_obj_field);
+            auto lg_builtins_ver = loadFieldValue(opcache_ptr, &_PyOpcache_LoadGlobal::builtins_ver,
+                    translator.tbaa_obj_field);
+            auto globals_ver = loadFieldValue(rt_globals, &PyDictObject::ma_version_tag, translator.tbaa_obj_field);
+            auto builtins_ver = loadFieldValue(rt_builtins, &PyDictObject::ma_version_tag, translator.tbaa_obj_field);
+            builder.CreateCondBr(builder.CreateAnd(builder.CreateICmpEQ(lg_globals_ver, globals_ver),
+                    builder.CreateICmpEQ(lg_builtins_ver, builtins_ver)), b_hit, b_miss);
+            builder.SetInsertPoint(b_hit);
+            auto cached = loadFieldValue(opcache_ptr, &_PyOpcache_LoadGlobal::ptr, translator.tbaa_obj_field);
+            pyIncRef(cached);
+            auto b_hit_end = builder.GetInsertBlock();
+            builder.CreateBr(b_end);
+
+            builder.SetInsertPoint(b_miss);
+            on_side_path = true;
+            auto loaded = emitCall<handle_LOAD_GLOBAL>(frame_obj, getName(oparg), opcache_ptr);
+            on_side_path = false;
+            auto b_miss_end = builder.GetInsertBlock();
+            builder.CreateBr(b_end);
+            builder.SetInsertPoint(b_end);
+            auto value = builder.CreatePHI(translator.type<PyObject *>(), 3);
+            value->addIncoming(entry_value, b_entry_hit_end);
+            value->addIncoming(cached, b_hit_end);
+            value->addIncoming(loaded, b_miss_end);
             pyPush(value);
             break;
         }
@@ -192,9 +281,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         }
         case LOAD_ATTR: {
             auto owner = pyPop();
-            auto jit_result = loadFieldValue(cframe, &ExtendedCFrame::translated_result, translator.tbaa_immutable);
-            auto opcache_arr = loadFieldValue(jit_result, &TranslatedResult::opcache_arr, translator.tbaa_immutable);
-            auto opcache_ptr = calcElementAddr<_PyOpcache>(opcache_arr, opcache_count++);
+            auto opcache_ptr = calcElementAddr<_PyOpcache>(rt_opcache_arr, opcache_count++);
             auto attr = emitCall<handle_LOAD_ATTR>(owner, getName(oparg), frame_obj, opcache_ptr);
             pyPush(attr);
             pyDecRef(owner);
@@ -221,7 +308,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             break;
         }
         case BINARY_SUBSCR: {
-            emitBinaryOperation<handle_BINARY_SUBSCR>();
+            emitBinaryOperation<handle_BINARY_SUBSCR>(opcode);
             break;
         }
         case STORE_SUBSCR: {
@@ -243,130 +330,135 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             break;
         }
         case UNARY_NOT: {
-            emitUnaryOperation<handle_UNARY_NOT>();
+            emitUnaryOperation<handle_UNARY_NOT>(opcode);
             break;
         }
         case UNARY_POSITIVE: {
-            emitUnaryOperation<handle_UNARY_POSITIVE>();
+            emitUnaryOperation<handle_UNARY_POSITIVE>(opcode);
             break;
         }
         case UNARY_NEGATIVE: {
-            emitUnaryOperation<handle_UNARY_NEGATIVE>();
+            emitUnaryOperation<handle_UNARY_NEGATIVE>(opcode);
             break;
         }
         case UNARY_INVERT: {
-            emitUnaryOperation<handle_UNARY_INVERT>();
+            emitUnaryOperation<handle_UNARY_INVERT>(opcode);
             break;
         }
         case BINARY_ADD: {
-            emitBinaryOperation<handle_BINARY_ADD>();
+            emitBinaryOperation<handle_BINARY_ADD>(opcode);
             break;
         }
         case INPLACE_ADD: {
-            emitBinaryOperation<handle_INPLACE_ADD>();
+            emitBinaryOperation<handle_INPLACE_ADD>(opcode);
             break;
         }
         case BINARY_SUBTRACT: {
-            emitBinaryOperation<handle_BINARY_SUBTRACT>();
+            emitBinaryOperation<handle_BINARY_SUBTRACT>(opcode);
             break;
         }
         case INPLACE_SUBTRACT: {
-            emitBinaryOperation<handle_INPLACE_SUBTRACT>();
+            emitBinaryOperation<handle_INPLACE_SUBTRACT>(opcode);
             break;
         }
         case BINARY_MULTIPLY: {
-            emitBinaryOperation<handle_BINARY_MULTIPLY>();
+            emitBinaryOperation<handle_BINARY_MULTIPLY>(opcode);
             break;
         }
         case INPLACE_MULTIPLY: {
-            emitBinaryOperation<handle_INPLACE_MULTIPLY>();
+            emitBinaryOperation<handle_INPLACE_MULTIPLY>(opcode);
             break;
         }
         case BINARY_FLOOR_DIVIDE: {
-            emitBinaryOperation<handle_BINARY_FLOOR_DIVIDE>();
+            emitBinaryOperation<handle_BINARY_FLOOR_DIVIDE>(opcode);
             break;
         }
         case INPLACE_FLOOR_DIVIDE: {
-            emitBinaryOperation<handle_INPLACE_FLOOR_DIVIDE>();
+            emitBinaryOperation<handle_INPLACE_FLOOR_DIVIDE>(opcode);
             break;
         }
         case BINARY_TRUE_DIVIDE: {
-            emitBinaryOperation<handle_BINARY_TRUE_DIVIDE>();
+            emitBinaryOperation<handle_BINARY_TRUE_DIVIDE>(opcode);
             break;
         }
         case INPLACE_TRUE_DIVIDE: {
-            emitBinaryOperation<handle_INPLACE_TRUE_DIVIDE>();
+            emitBinaryOperation<handle_INPLACE_TRUE_DIVIDE>(opcode);
             break;
         }
         case BINARY_MODULO: {
-            emitBinaryOperation<handle_BINARY_MODULO>();
+            emitBinaryOperation<handle_BINARY_MODULO>(opcode);
             break;
         }
         case INPLACE_MODULO: {
-            emitBinaryOperation<handle_INPLACE_MODULO>();
+            emitBinaryOperation<handle_INPLACE_MODULO>(opcode);
             break;
         }
         case BINARY_POWER: {
-            emitBinaryOperation<handle_BINARY_POWER>();
+            emitBinaryOperation<handle_BINARY_POWER>(opcode);
             break;
         }
         case INPLACE_POWER: {
-            emitBinaryOperation<handle_INPLACE_POWER>();
+            emitBinaryOperation<handle_INPLACE_POWER>(opcode);
             break;
         }
         case BINARY_MATRIX_MULTIPLY: {
-            emitBinaryOperation<handle_BINARY_MATRIX_MULTIPLY>();
+            emitBinaryOperation<handle_BINARY_MATRIX_MULTIPLY>(opcode);
             break;
         }
         case INPLACE_MATRIX_MULTIPLY: {
-            emitBinaryOperation<handle_INPLACE_MATRIX_MULTIPLY>();
+            emitBinaryOperation<handle_INPLACE_MATRIX_MULTIPLY>(opcode);
             break;
         }
         case BINARY_LSHIFT: {
-            emitBinaryOperation<handle_BINARY_LSHIFT>();
+            emitBinaryOperation<handle_BINARY_LSHIFT>(opcode);
             break;
         }
         case INPLACE_LSHIFT: {
-            emitBinaryOperation<handle_INPLACE_LSHIFT>();
+            emitBinaryOperation<handle_INPLACE_LSHIFT>(opcode);
             break;
         }
         case BINARY_RSHIFT: {
-            emitBinaryOperation<handle_BINARY_RSHIFT>();
+            emitBinaryOperation<handle_BINARY_RSHIFT>(opcode);
             break;
         }
         case INPLACE_RSHIFT: {
-            emitBinaryOperation<handle_INPLACE_RSHIFT>();
+            emitBinaryOperation<handle_INPLACE_RSHIFT>(opcode);
             break;
         }
         case BINARY_AND: {
-            emitBinaryOperation<handle_BINARY_AND>();
+            emitBinaryOperation<handle_BINARY_AND>(opcode);
             break;
         }
         case INPLACE_AND: {
-            emitBinaryOperation<handle_INPLACE_AND>();
+            emitBinaryOperation<handle_INPLACE_AND>(opcode);
             break;
         }
         case BINARY_OR: {
-            emitBinaryOperation<handle_BINARY_OR>();
+            emitBinaryOperation<handle_BINARY_OR>(opcode);
             break;
         }
         case INPLACE_OR: {
-            emitBinaryOperation<handle_INPLACE_OR>();
+            emitBinaryOperation<handle_INPLACE_OR>(opcode);
             break;
         }
         case BINARY_XOR: {
-            emitBinaryOperation<handle_BINARY_XOR>();
+            emitBinaryOperation<handle_BINARY_XOR>(opcode);
             break;
         }
         case INPLACE_XOR: {
-            emitBinaryOperation<handle_INPLACE_XOR>();
+            emitBinaryOperation<handle_INPLACE_XOR>(opcode);
             break;
         }
         case COMPARE_OP: {
             auto right = pyPop();
             auto left = pyPop();
-            auto res = emitCall<handle_COMPARE_OP>(left, right, oparg);
-            pyPush(res);
+            if (auto cond = emitInlineComparison(oparg, left, right)) {
+                pyPushBool(cond);
+            } else {
+                auto res = emitCall<handle_COMPARE_OP>(left, right, oparg);
+                pyPush(res);
+                declareTopType(inferBinaryResultType(opcode, left.type, right.type));
+            }
             pyDecRef(left);
             pyDecRef(right);
             break;
@@ -374,14 +466,15 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         case IS_OP: {
             auto right = pyPop();
             auto left = pyPop();
-            auto res = builder.CreateICmpEQ(left, right);
-            auto py_true = getSymbol<_Py_TrueStruct>();
-            auto py_false = getSymbol<_Py_FalseStruct>();
-            auto value_for_true = !oparg ? py_true : py_false;
-            auto value_for_false = !oparg ? py_false : py_true;
-            auto value = builder.CreateSelect(res, value_for_true, value_for_false);
-            pyIncRef(value);
-            pyPush(value);
+            Value *res;
+            // Note: values of different known types are never identical, and None is a singleton
+            if (left.type != KnownType::ANY && right.type != KnownType::ANY
+                    && (left.type != right.type || left.type == KnownType::NONE)) {
+                res = ConstantInt::getBool(translator.llvm_context, (left.type == right.type) == !oparg);
+            } else {
+                res = !oparg ? builder.CreateICmpEQ(left, right) : builder.CreateICmpNE(left, right);
+            }
+            pyPushBool(res);
             pyDecRef(left);
             pyDecRef(right);
             break;
@@ -389,13 +482,16 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         case CONTAINS_OP: {
             auto right = pyPop();
             auto left = pyPop();
-            auto value = emitCall<handle_CONTAINS_OP>(left, right, oparg);
-            pyPush(value);
+            auto found = emitCall<handle_CONTAINS_OP>(left, right);
+            auto res = !oparg ? builder.CreateICmpNE(found, getConstantInt<int>(0))
+                    : builder.CreateICmpEQ(found, getConstantInt<int>(0));
+            pyPushBool(res);
             pyDecRef(left);
             pyDecRef(right);
             break;
         }
         case RETURN_VALUE: {
+            ownStackValue(abstract_stack_top[-1]);
             auto retval = pyPop();
             assert(retval.really_pushed);
             assert(stack_height == 0);
@@ -447,8 +543,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         }
         case LOAD_CLOSURE: {
             auto cell = getFreevar(oparg);
-            pyIncRef(cell);
-            pyPush(cell);
+            pyPushBorrowed(cell);
             break;
         }
         case MAKE_FUNCTION: {
@@ -492,27 +587,34 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         }
 
         case JUMP_FORWARD: {
+            spillStack();
             builder.CreateBr(this_block.branch());
             return;
         }
         case JUMP_ABSOLUTE: {
-            if (this_block.branch().begin_vpc <= this_block.begin_vpc) {
+            auto is_back_edge = this_block.branch().begin_vpc <= this_block.begin_vpc;
+            if (is_back_edge) {
                 declareBlockAsHandler(this_block.branch());
             }
 
-            emitCheckEvalBreaker(this_block.branch().begin_vpc);
+            spillStack();
+            if (is_back_edge) {
+                emitSafepoint(this_block.branch().begin_vpc, lasti);
+            }
             builder.CreateBr(this_block.branch());
             return;
         }
         case POP_JUMP_IF_TRUE:
         case POP_JUMP_IF_FALSE: {
-            if (this_block.branch().begin_vpc <= this_block.begin_vpc) {
+            auto is_back_edge = this_block.branch().begin_vpc <= this_block.begin_vpc;
+            if (is_back_edge) {
                 declareBlockAsHandler(this_block.branch());
             }
             auto cond_obj = pyPop();
+            spillStack();
             auto pre_branch = createBlock(function);
             auto pre_fall = cond_obj.really_pushed ? createBlock(function) : this_block.fall();
-            emitConditionalJump(cond_obj, opcode == POP_JUMP_IF_TRUE, pre_branch, pre_fall);
+            emitConditionalJump(cond_obj, opcode == POP_JUMP_IF_TRUE, pre_branch, pre_fall, cond_obj.type);
             if (cond_obj.really_pushed) {
                 builder.SetInsertPoint(pre_fall);
                 pyDecRef(cond_obj);
@@ -520,16 +622,20 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             }
             builder.SetInsertPoint(pre_branch);
             pyDecRef(cond_obj);
-            emitCheckEvalBreaker(this_block.branch().begin_vpc);
+            if (is_back_edge) {
+                emitSafepoint(this_block.branch().begin_vpc, lasti, opcode == POP_JUMP_IF_TRUE ?
+                        getSymbol<_Py_TrueStruct>() : getSymbol<_Py_FalseStruct>());
+            }
             builder.CreateBr(this_block.branch());
             return;
         }
         case JUMP_IF_TRUE_OR_POP:
         case JUMP_IF_FALSE_OR_POP: {
+            spillStack();
             auto value = pyPop();
             assert(value.really_pushed);
             auto pre_fall = createBlock(function);
-            emitConditionalJump(value, opcode == JUMP_IF_TRUE_OR_POP, this_block.branch(), pre_fall);
+            emitConditionalJump(value, opcode == JUMP_IF_TRUE_OR_POP, this_block.branch(), pre_fall, value.type);
             builder.SetInsertPoint(pre_fall);
             pyDecRef(value);
             builder.CreateBr(this_block.fall());
@@ -550,11 +656,21 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             auto next = builder.CreateCall(translator.type<std::remove_pointer_t<iternextfunc>>(),
                     the_iternextfunc, {iter});
             pyPush(next);
+            // Note: the loop body can take over the abstract stack if it is only entered from here
+            auto &body = this_block.fall();
+            keep_abstract_stack = body.predecessor_num == 1
+                    && _Py_OPCODE(py_code.instrData()[body.begin_vpc]) != YIELD_FROM;
+            if (!keep_abstract_stack) {
+                spillStack();
+            }
             auto break_block = createBlock(function, "FOR_ITER.break");
             builder.CreateCondBr(builder.CreateICmpEQ(next, translator.c_null),
-                    break_block, this_block.fall(), translator.unlikely);
+                    break_block, body, translator.unlikely);
             builder.SetInsertPoint(break_block);
+            on_side_path = true;
+            spillStack(abstract_stack_top - 1, false);
             emitCall<handle_FOR_ITER>(iter);
+            on_side_path = false;
             builder.CreateBr(this_block.branch());
             return;
         }
@@ -563,18 +679,32 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             auto values = declareStackShrink(oparg);
             auto str = emitCall<handle_BUILD_STRING>(values, oparg);
             pyPush(str);
+            declareTopType(KnownType::STR);
             break;
         }
-        case BUILD_TUPLE: {
-            auto values = declareStackShrink(oparg);
-            auto map = emitCall<handle_BUILD_TUPLE>(values, oparg);
-            pyPush(map);
-            break;
-        }
+        case BUILD_TUPLE:
         case BUILD_LIST: {
-            auto values = declareStackShrink(oparg);
-            auto map = emitCall<handle_BUILD_LIST>(values, oparg);
-            pyPush(map);
+            if (oparg > 8) {
+                auto values = declareStackShrink(oparg);
+                auto seq = opcode == BUILD_TUPLE ? emitCall<handle_BUILD_TUPLE>(values, oparg)
+                        : emitCall<handle_BUILD_LIST>(values, oparg);
+                pyPush(seq);
+                declareTopType(opcode == BUILD_TUPLE ? KnownType::TUPLE : KnownType::LIST);
+                break;
+            }
+            // Note: small sequences are filled from SSA registers, without spilling the items to the frame
+            auto seq = opcode == BUILD_TUPLE ? emitLeafCall<PyTuple_New>(oparg) : emitLeafCall<PyList_New>(oparg);
+            auto items = opcode == BUILD_TUPLE ? calcElementAddr(seq, offsetof(PyTupleObject, ob_item))
+                    : loadFieldValue(seq, &PyListObject::ob_item, translator.tbaa_obj_field);
+            for (auto i = oparg; i--;) {
+                auto value = pyPop();
+                if (!value.really_pushed) {
+                    pyIncRef(value);
+                }
+                storeValue<PyObject *>(value, calcElementAddr<PyObject *>(items, i), translator.tbaa_obj_field);
+            }
+            pyPush(seq);
+            declareTopType(opcode == BUILD_TUPLE ? KnownType::TUPLE : KnownType::LIST);
             break;
         }
         case BUILD_SET: {
@@ -587,12 +717,14 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             auto values = declareStackShrink(2 * oparg);
             auto map = emitCall<handle_BUILD_MAP>(values, oparg);
             pyPush(map);
+            declareTopType(KnownType::DICT);
             break;
         }
         case BUILD_CONST_KEY_MAP: {
             auto values = declareStackShrink(oparg + 1);
             auto map = emitCall<handle_BUILD_CONST_KEY_MAP>(values, oparg);
             pyPush(map);
+            declareTopType(KnownType::DICT);
             break;
         }
         case LIST_APPEND: {
@@ -651,6 +783,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             auto list = pyPop();
             auto tuple = emitCall<handle_LIST_TO_TUPLE>(list);
             pyPush(tuple);
+            declareTopType(KnownType::TUPLE);
             pyDecRef(list);
             break;
         }
@@ -665,12 +798,50 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             }
             auto value = pyPop();
             int which_conversion = oparg & FVC_MASK;
-            auto result = emitCall<handle_FORMAT_VALUE>(value, fmt_spec, which_conversion);
-            pyPush(result);
-            pyDecRef(value);
-            if (really_pushed) {
-                pyDecRef(fmt_spec);
+            if (fmt_spec != translator.c_null || (which_conversion != FVC_NONE && which_conversion != FVC_STR)) {
+                auto result = emitCall<handle_FORMAT_VALUE>(value, fmt_spec, which_conversion);
+                pyPush(result);
+                declareTopType(KnownType::STR);
+                pyDecRef(value);
+                if (really_pushed) {
+                    pyDecRef(fmt_spec);
+                }
+                break;
+            }
+            if (value.type == KnownType::STR) {
+                if (!value.really_pushed) {
+                    pyIncRef(value);
+                }
+                pyPush(value);
+                declareTopType(KnownType::STR);
+                break;
+            }
+
+            // Note: an exact str is passed through as is
+            auto b_str = createBlock(function, "FORMAT_VALUE.str");
+            auto b_format = createBlock(function, "FORMAT_VALUE.format");
+            auto b_end = createBlock(function, "FORMAT_VALUE.end");
+            auto ob_type = loadFieldValue(value, &PyObject::ob_type, translator.tbaa_obj_field);
+            builder.CreateCondBr(builder.CreateICmpEQ(ob_type, getSymbol<PyUnicode_Type>()), b_str, b_format);
+            builder.SetInsertPoint(b_str);
+            if (!value.really_pushed) {
+                pyIncRef(value);
             }
+            auto b_str_end = builder.GetInsertBlock();
+            builder.CreateBr(b_end);
+            builder.SetInsertPoint(b_format);
+            on_side_path = true;
+            auto formatted = emitCall<handle_FORMAT_VALUE>(value, translator.c_null, which_conversion);
+            pyDecRef(value);
+            on_side_path = false;
+            auto b_format_end = builder.GetInsertBlock();
+            builder.CreateBr(b_end);
+            builder.SetInsertPoint(b_end);
+            auto result = builder.CreatePHI(translator.type<PyObject *>(), 2);
+            result->addIncoming(value, b_str_end);
+            result->addIncoming(formatted, b_format_end);
+            pyPush(result);
+            declareTopType(KnownType::STR);
             break;
         }
         case BUILD_SLICE: {
@@ -695,8 +866,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         case LOAD_ASSERTION_ERROR: {
             auto ptr = getSymbol<PyExc_AssertionError>();
             auto value = loadValue<void *>(ptr, translator.tbaa_immutable);
-            pyIncRef(value);
-            pyPush(value);
+            pyPushBorrowed(value);
             break;
         }
         case SETUP_ANNOTATIONS: {
@@ -712,9 +882,74 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
 
         case UNPACK_SEQUENCE: {
             auto seq = pyPop();
-            emitCall<handle_UNPACK_SEQUENCE>(seq, oparg, getStackSlot());
+            if (oparg > 8) {
+                emitCall<handle_UNPACK_SEQUENCE>(seq, oparg, getStackSlot());
+                pyDecRef(seq);
+                declareStackGrowth(oparg);
+                break;
+            }
+
+            // Note: exact tuples and lists of the right size are unpacked into SSA registers directly
+            auto b_tuple = createBlock(function, "UNPACK_SEQUENCE.tuple");
+            auto b_not_tuple = createBlock(function, "UNPACK_SEQUENCE.not_tuple");
+            auto b_list = createBlock(function, "UNPACK_SEQUENCE.list");
+            auto b_check_size = createBlock(function, "UNPACK_SEQUENCE.check_size");
+            auto b_fast = createBlock(function, "UNPACK_SEQUENCE.fast");
+            auto b_slow = createBlock(function, "UNPACK_SEQUENCE.slow");
+            auto b_end = createBlock(function, "UNPACK_SEQUENCE.end");
+            auto ob_type = loadFieldValue(seq, &PyObject::ob_type, translator.tbaa_obj_field);
+            builder.CreateCondBr(builder.CreateICmpEQ(ob_type, getSymbol<PyTuple_Type>()), b_tuple, b_not_tuple);
+            builder.SetInsertPoint(b_not_tuple);
+            builder.CreateCondBr(builder.CreateICmpEQ(ob_type, getSymbol<PyList_Type>()), b_list, b_slow);
+            builder.SetInsertPoint(b_tuple);
+            auto tuple_items = calcElementAddr(seq, offsetof(PyTupleObject, ob_item));
+            builder.CreateBr(b_check_size);
+            builder.SetInsertPoint(b_list);
+            auto list_items = loadFieldValue(seq, &PyListObject::ob_item, translator.tbaa_obj_field);
+            builder.CreateBr(b_check_size);
+            builder.SetInsertPoint(b_check_size);
+            auto items = builder.CreatePHI(translator.type<PyObject **>(), 2);
+            items->addIncoming(tuple_items, b_tuple);
+            items->addIncoming(list_items, b_list);
+            auto size = loadFieldValue(seq, &PyVarObject::ob_size, translator.tbaa_obj_field);
+            builder.CreateCondBr(builder.CreateICmpNE(size, getConstantInt<Py_ssize_t>(oparg)),
+                    b_slow, b_fast, translator.unlikely);
+
+            builder.SetInsertPoint(b_fast);
+            Value *fast_values[8];
+            for (auto i : IntRange(oparg)) {
+                fast_values[i] = loadValue<PyObject *>(calcElementAddr<PyObject *>(items, oparg - 1 - i),
+                        translator.tbaa_obj_field);
+                pyIncRef(fast_values[i]);
+            }
+            auto b_fast_end = builder.GetInsertBlock();
+            builder.CreateBr(b_end);
+
+            builder.SetInsertPoint(b_slow);
+            on_side_path = true;
+            auto dest = getStackSlot();
+            emitCall<handle_UNPACK_SEQUENCE>(seq, oparg, dest);
+            Value *slow_values[8];
+            for (auto i : IntRange(oparg)) {
+                slow_values[i] = loadValue<PyObject *>(calcElementAddr<PyObject *>(dest, i),
+                        translator.tbaa_frame_field);
+            }
+            on_side_path = false;
+            auto b_slow_end = builder.GetInsertBlock();
+            builder.CreateBr(b_end);
+
+            builder.SetInsertPoint(b_end);
+            Value *values[8];
+            for (auto i : IntRange(oparg)) {
+                auto phi = builder.CreatePHI(translator.type<PyObject *>(), 2);
+                phi->addIncoming(fast_values[i], b_fast_end);
+                phi->addIncoming(slow_values[i], b_slow_end);
+                values[i] = phi;
+            }
             pyDecRef(seq);
-            declareStackGrowth(oparg);
+            for (auto i : IntRange(oparg)) {
+                pyPush(values[i]);
+            }
             break;
         }
         case UNPACK_EX: {
@@ -731,6 +966,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             auto value = fetchStackValue(1);
             auto len = emitCall<hanlde_GET_LEN>(value);
             pyPush(len);
+            declareTopType(KnownType::INT);
             break;
         }
         case MATCH_MAPPING:
@@ -744,8 +980,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             auto py_true = getSymbol<_Py_TrueStruct>();
             auto py_false = getSymbol<_Py_FalseStruct>();
             auto res = builder.CreateSelect(match_bool, py_true, py_false);
-            pyIncRef(res);
-            pyPush(res);
+            pyPushBorrowed(res);
             break;
         }
         case MATCH_KEYS: {
@@ -791,17 +1026,18 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             auto match = emitCall<handle_JUMP_IF_NOT_EXC_MATCH>(left, right);
             pyDecRef(left);
             pyDecRef(right);
-            builder.CreateCondBr(match, this_block.fall(), this_block.branch());
+            builder.CreateCondBr(builder.CreateICmpNE(match, getConstantInt<int>(0)),
+                    this_block.fall(), this_block.branch());
             return;
         }
         case RERAISE: {
-            emitCall<handle_RERAISE>(oparg, stack_height);
-            builder.CreateUnreachable();
+            emitRaise<handle_RERAISE>(oparg, stack_height);
             return;
         }
         case SETUP_WITH: {
             declareBlockAsHandler(this_block.branch());
             emitCall<handle_SETUP_WITH>(frame_obj, this_block.branch().begin_vpc, stack_height);
+            abstract_stack_top[-1].value = nullptr;
             declareStackGrowth(1);
             builder.CreateBr(this_block.fall());
             return;
@@ -813,8 +1049,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         }
         case RAISE_VARARGS: {
             assert(0 <= oparg && oparg <= 2);
-            emitCall<handle_RAISE_VARARGS>(oparg, stack_height);
-            builder.CreateUnreachable();
+            emitRaise<handle_RAISE_VARARGS>(oparg, stack_height);
             return;
         }
 
@@ -824,6 +1059,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             break;
         }
         case YIELD_VALUE: {
+            ownStackValue(abstract_stack_top[-1]);
             auto retval = pyPop();
             assert(retval.really_pushed);
             Value *retval_ = retval;
@@ -837,11 +1073,14 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         }
         case YIELD_FROM: {
             auto inputs_outputs = declareStackShrink(2);
-            auto value = emitCall<handle_YIELD_FROM>(inputs_outputs);
+            auto gen_status = emitCall<handle_YIELD_FROM>(inputs_outputs);
             declareStackGrowth(1);
 
             auto b_finish = createBlock(nullptr, "YIELD_FROM.finish");
-            emitUnlikelyJump(builder.CreateICmpEQ(value, translator.c_null), b_finish, "YIELD_FROM.next");
+            emitUnlikelyJump(builder.CreateICmpEQ(gen_status, getConstantInt<int>(PYGEN_RETURN)),
+                    b_finish, "YIELD_FROM.next");
+            auto value = loadValue<PyObject *>(calcElementAddr<PyObject *>(inputs_outputs, 1),
+                    translator.tbaa_frame_field);
 
             declareBlockAsHandler(this_block);
             storeFieldValue(lasti - 1, frame_obj, &PyFrameObject::f_lasti, translator.tbaa_frame_field);
@@ -882,7 +1121,13 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
             break;
         }
         case END_ASYNC_FOR: {
-            emitCall<handle_END_ASYNC_FOR>(stack_height);
+            auto b_reraise = createBlock(function, "END_ASYNC_FOR.reraise");
+            auto b_end = createBlock(nullptr, "END_ASYNC_FOR.end");
+            builder.CreateCondBr(emitCall<handle_END_ASYNC_FOR>(stack_height), b_end, b_reraise);
+            builder.SetInsertPoint(b_reraise);
+            emitRaise<handle_RERAISE>(false, stack_height);
+            b_end->insertInto(function);
+            builder.SetInsertPoint(b_end);
             declareStackShrink(7);
             break;
         }
@@ -895,6 +1140,7 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
         }
         case BEFORE_ASYNC_WITH: {
             emitCall<handle_BEFORE_ASYNC_WITH>(getStackSlot());
+            abstract_stack_top[-1].value = nullptr;
             declareStackGrowth(1);
             break;
         }
@@ -905,5 +1151,9 @@ void CompilationUnit::emitBlock(PyCodeBlock &this_block, DebugInfo &debug_info)
 
     assert(this_block.fall_block && !this_block.branch_block);
     assert(!builder.GetInsertBlock()->getTerminator());
+    spillStack();
+#ifndef NDEBUG
+    checkStackOwnership(true);
+#endif
     builder.CreateBr(this_block.fall());
 }
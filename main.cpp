@@ -11,15 +11,16 @@
 
 static Translator *translator;
 PyObject compilation_error;
+PyObject deoptimized_frame;
 int jit_threshold = 0x4000;
 
 void notifyCodeLoaded(void *bin_addr, PyObject *py_code) {}
 
-static TranslatedResult *compilePythonCode(PyCode py_code, PyObject *debug_args) {
+static TranslatedResult *translatePythonCode(PyCode py_code, PyObject *debug_args, ArgTypes arg_types) {
     // Note: Make sure there are no errors raised before compiling.
     assert(!PyErr_Occurred());
 
-    BinCodeCache bin_code_cache{py_code};
+    BinCodeCache bin_code_cache{py_code, arg_types};
     auto result = bin_code_cache.load();
     if (!result) {
         if (!translator) {
@@ -29,20 +30,62 @@ static TranslatedResult *compilePythonCode(PyCode py_code, PyObject *debug_args)
                 return nullptr;
             }
         }
-        CompilationUnit cu{*translator, py_code};
+        CompilationUnit cu{*translator, py_code, arg_types};
         if (cu.translate(debug_args)) {
             result = bin_code_cache.store(cu);
         }
     }
     if (result) {
-        if (_PyCode_SetExtra(py_code, code_extra_index, result) == 0) {
-            notifyCodeLoaded(result->entry_address(), py_code);
+        result->inlinable_body = InlinableBody::recognize(py_code);
+        notifyCodeLoaded(result->entry_address(), py_code);
+    }
+    return result;
+}
+
+static TranslatedResult *compilePythonCode(PyCode py_code, PyObject *debug_args) {
+    auto result = translatePythonCode(py_code, debug_args, {});
+    if (result) {
+        auto versions = new CodeVersions{result, ArgTypes::specializableArgs(py_code), specialize_threshold};
+        if (_PyCode_SetExtra(py_code, code_extra_index, versions) == 0) {
             return result;
         }
+        CodeVersions::destroy(versions);
     }
     return nullptr;
 }
 
+// Note: pick the version specialized for the exact types of the arguments,
+//  and specialize for a signature that keeps missing when there is room for another version
+static TranslatedResult *selectVersion(PyFrameObject *f, CodeVersions &versions) {
+    ArgTypes arg_types{0};
+    for (auto i : IntRange(ArgTypes::max_arg_num)) {
+        if (versions.specializable_args >> i & 1) {
+            arg_types.set(i, classifyType(Py_TYPE(f->f_localsplus[i])));
+        }
+    }
+    if (!arg_types) {
+        return versions.generic;
+    }
+    for (auto i : IntRange(versions.specialized_num)) {
+        if (versions.arg_types[i] == arg_types) {
+            return versions.specialized[i];
+        }
+    }
+    if (versions.specialized_num == CodeVersions::max_specialized_num || --versions.specialize_countdown > 0) {
+        return versions.generic;
+    }
+    versions.specialize_countdown = specialize_threshold;
+    auto result = translatePythonCode(f->f_code, nullptr, arg_types);
+    if (!result) {
+        PyErr_Clear();
+        versions.specializable_args = 0;
+        return versions.generic;
+    }
+    versions.arg_types[versions.specialized_num] = arg_types;
+    versions.specialized[versions.specialized_num++] = result;
+    return result;
+}
+
 template <bool new_eval, typename T>
 static PyObject *evalFrame(PyThreadState *tstate, PyFrameObject *f, T throwflag_or_vpc) {
     if constexpr (new_eval) {
@@ -71,11 +114,17 @@ static PyObject *evalFrame(PyThreadState *tstate, PyFrameObject *f, T throwflag_
             }
         }
     }
+    if constexpr (new_eval) {
+        if (auto &versions = getCodeVersions(f->f_code); versions.specializable_args && f->f_lasti < 0) {
+            translated_result = selectVersion(f, versions);
+        }
+    }
 
     ExtendedCFrame cframe{
             {tstate->cframe->use_tracing, tstate->cframe},
             translated_result
     };
+    cframe.safepoint_countdown = safepoint_interval;
     if constexpr (new_eval) {
         cframe.handler = f->f_lasti < 0 ? 0 : translated_result->calcPC(f->f_lasti + 1);
 
@@ -92,20 +141,21 @@ static PyObject *evalFrame(PyThreadState *tstate, PyFrameObject *f, T throwflag_
 
     tstate->cframe = &cframe;
 
-    PyObject *ret_val = nullptr;
     void *eval_breaker = &tstate->interp->ceval.eval_breaker;
-    if (setjmp(cframe.frame_jmp_buf) >= 0) {
-        assert(!_PyErr_Occurred(tstate));
-        ret_val = (*translated_result)(RuntimeSymbols::address_array.data(), f, &cframe, eval_breaker);
-    }
+    assert(!_PyErr_Occurred(tstate));
+    auto ret_val = (*translated_result)(RuntimeSymbols::address_array.data(), f, &cframe, eval_breaker);
     assert(!ret_val ^ !_PyErr_Occurred(tstate));
-    assert(f->f_state == FRAME_SUSPENDED || !f->f_stackdepth);
+    assert(f->f_state == FRAME_SUSPENDED || !f->f_stackdepth || ret_val == &deoptimized_frame);
 
     tstate->cframe = cframe.previous;
     tstate->cframe->use_tracing = cframe.use_tracing;
     if constexpr (new_eval) {
         tstate->frame = f->f_back;
         _Py_LeaveRecursiveCall(tstate);
+        // Note: the translated code has written back f_lasti and the value stack, so the frame resumes there
+        if (ret_val == &deoptimized_frame) {
+            return Ported_PyEval_EvalFrameDefault(tstate, f, DEOPTIMIZED_THROWFLAG);
+        }
     }
     return ret_val;
 }
@@ -146,6 +196,15 @@ PyObject *setup() {
         if (end != env_value && *end == '\0') {
             auto new_threshold = jit_threshold * ratio;
             jit_threshold = new_threshold > INT_MAX ? INT_MAX : static_cast<int>(new_threshold);
+            new_threshold = specialize_threshold * ratio;
+            specialize_threshold = new_threshold > INT_MAX ? INT_MAX : static_cast<int>(new_threshold);
+        }
+    }
+    if (auto env_value = getenv("COMPYLER_SAFEPOINT_INTERVAL")) {
+        char *end;
+        auto interval = strtol(env_value, &end, 10);
+        if (end != env_value && *end == '\0' && interval > 0) {
+            safepoint_interval = interval > INT_MAX ? INT_MAX : static_cast<int>(interval);
         }
     }
     if (auto env_value = getenv("COMPYLER_CACHE_ROOT")) {
@@ -184,7 +243,7 @@ PyObject *setup() {
             }
     };
 
-    if ((code_extra_index = _PyEval_RequestCodeExtraIndex(TranslatedResult::destroy)) < 0) {
+    if ((code_extra_index = _PyEval_RequestCodeExtraIndex(CodeVersions::destroy)) < 0) {
         return nullptr;
     }
 
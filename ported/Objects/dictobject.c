@@ -1,4 +1,5 @@
 #include "Python.h"
+#include <stddef.h>
 #include "dict-common.h"
 
 
@@ -55,13 +56,22 @@ _PyDict_GetItemHint(PyDictObject *mp, PyObject *key,
     return (mp->ma_keys->dk_lookup)(mp, key, hash, value);
 }
 
+const Py_ssize_t dict_keys_size_offset = offsetof(PyDictKeysObject, dk_size);
+const Py_ssize_t dict_entry_key_offset = offsetof(PyDictKeyEntry, me_key);
+const Py_ssize_t dict_entry_value_offset = offsetof(PyDictKeyEntry, me_value);
+
+/* comPyler: when the value comes from a combined globals table, also report
+ * the byte offset of its entry from globals->ma_keys and the size of the keys,
+ * otherwise *entry_offset is set to -1. */
 PyObject *
-_PyDict_LoadGlobal(PyDictObject *globals, PyDictObject *builtins, PyObject *key)
+_PyDict_LoadGlobalEntry(PyDictObject *globals, PyDictObject *builtins, PyObject *key,
+        Py_ssize_t *entry_offset, Py_ssize_t *keys_size)
 {
     Py_ssize_t ix;
     Py_hash_t hash;
     PyObject *value;
 
+    *entry_offset = -1;
     if (!PyUnicode_CheckExact(key) ||
             (hash = ((PyASCIIObject *) key)->hash) == -1)
     {
@@ -74,8 +84,14 @@ _PyDict_LoadGlobal(PyDictObject *globals, PyDictObject *builtins, PyObject *key)
     ix = globals->ma_keys->dk_lookup(globals, key, hash, &value);
     if (ix == DKIX_ERROR)
         return NULL;
-    if (ix != DKIX_EMPTY && value != NULL)
+    if (ix != DKIX_EMPTY && value != NULL) {
+        PyDictKeyEntry *ep = DK_ENTRIES(globals->ma_keys) + ix;
+        if (!globals->ma_values && ep->me_key == key) {
+            *entry_offset = (char *) ep - (char *) globals->ma_keys;
+            *keys_size = DK_SIZE(globals->ma_keys);
+        }
         return value;
+    }
 
     /* namespace 2: builtins */
     ix = builtins->ma_keys->dk_lookup(builtins, key, hash, &value);
@@ -83,3 +99,10 @@ _PyDict_LoadGlobal(PyDictObject *globals, PyDictObject *builtins, PyObject *key)
         return NULL;
     return value;
 }
+
+PyObject *
+_PyDict_LoadGlobal(PyDictObject *globals, PyDictObject *builtins, PyObject *key)
+{
+    Py_ssize_t entry_offset, keys_size;
+    return _PyDict_LoadGlobalEntry(globals, builtins, key, &entry_offset, &keys_size);
+}
@@ -752,6 +752,12 @@ eval_frame_handle_pending(PyThreadState *tstate)
             PyObject *result = tackOverFrame(tstate, f, INSTR_OFFSET()); \
             if (result == &compilation_error) \
                 goto error; \
+            if (result == &deoptimized_frame) { \
+                next_instr = first_instr + f->f_lasti + 1; \
+                stack_pointer = f->f_valuestack + f->f_stackdepth; \
+                f->f_stackdepth = -1; \
+                DISPATCH(); \
+            } \
             retval = result; \
             goto exiting; \
         }
@@ -944,7 +950,8 @@ Ported_PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int thro
     tstate->frame = f;
     co = f->f_code;
 
-    if (trace_info.cframe.use_tracing) {
+    /* comPyler: a deoptimized frame is resumed rather than called */
+    if (trace_info.cframe.use_tracing && throwflag != DEOPTIMIZED_THROWFLAG) {
         if (tstate->c_tracefunc != NULL) {
             /* tstate->c_tracefunc, if defined, is a
                function that will be called on *every* entry
@@ -1030,7 +1037,7 @@ Ported_PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int thro
 #endif
 
     co->co_opcache_flag -= f->f_lasti + 1;
-    if (throwflag) { /* support for generator.throw() */
+    if (throwflag > 0) { /* support for generator.throw() */
         goto error;
     }
 
@@ -5,6 +5,9 @@
 
 extern int jit_threshold;
 
+// Note: passed as throwflag to continue a frame left by the translated code
+#define DEOPTIMIZED_THROWFLAG (-1)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -12,8 +15,15 @@ extern "C" {
 PyObject *Ported_PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag);
 PyObject *tackOverFrame(PyThreadState *tstate, PyFrameObject *f, int vpc);
 int eval_frame_handle_pending(PyThreadState *tstate);
+PyObject *_PyDict_LoadGlobalEntry(PyDictObject *globals, PyDictObject *builtins, PyObject *key,
+        Py_ssize_t *entry_offset, Py_ssize_t *keys_size);
+
+extern const Py_ssize_t dict_keys_size_offset;
+extern const Py_ssize_t dict_entry_key_offset;
+extern const Py_ssize_t dict_entry_value_offset;
 
 extern PyObject compilation_error;
+extern PyObject deoptimized_frame;
 
 #ifdef __cplusplus
 }
@@ -23,6 +23,8 @@ void format_awaitable_error(PyThreadState *, PyTypeObject *, int, int);
 }
 
 
+static auto getThreadState() { return _PyThreadState_GET(); }
+
 static void restoreExcInfo(PyThreadState *tstate, PyObject **exc_triple) {
     auto exc_info = *tstate->exc_info;
     tstate->exc_info->exc_type = exc_triple[2];
@@ -40,7 +42,9 @@ static void clearStack(PyFrameObject *f, int &height, int until_height) {
     }
 }
 
-[[noreturn]] static void unwindFrame(PyThreadState *tstate, int stack_height) {
+// Note: If the exception is caught in this frame, the handler to resume at is left in cframe->handler.
+// Otherwise, the frame is cleared and the translated function should return NULL.
+static bool unwindFrame(PyThreadState *tstate, int stack_height) {
     assert(tstate->frame->f_stackdepth == -1);
     auto cframe = static_cast<ExtendedCFrame *>(tstate->cframe);
     auto f = tstate->frame;
@@ -82,18 +86,17 @@ static void clearStack(PyFrameObject *f, int &height, int until_height) {
         f->f_valuestack[stack_height++] = Py_NewRef(exc);
         cframe->handler = cframe->translated_result->calcPC(handler);
         f->f_state = FRAME_EXECUTING;
-        longjmp(cframe->frame_jmp_buf, 1);
+        return true;
     }
 
     clearStack(f, stack_height, 0);
     f->f_stackdepth = 0;
     f->f_state = FRAME_RAISED;
-    longjmp(cframe->frame_jmp_buf, -1);
+    return false;
 }
 
-static auto getThreadState() { return _PyThreadState_GET(); }
-
-[[noreturn]] static void gotoErrorHandler(PyThreadState *tstate) {
+bool handleError() {
+    auto tstate = getThreadState();
     assert(_PyErr_Occurred(tstate));
     auto cframe = static_cast<ExtendedCFrame *>(tstate->cframe);
     int stack_height;
@@ -105,24 +108,16 @@ static auto getThreadState() { return _PyThreadState_GET(); }
     }
     PyTraceBack_Here(f);
     /* Note: tracefunc support here */
-    unwindFrame(tstate, stack_height);
+    return unwindFrame(tstate, stack_height);
 }
 
-[[noreturn]] static void gotoErrorHandler() { gotoErrorHandler(getThreadState()); }
-
-static void gotoErrorHandlerIf(bool cond, auto... args) {
-    if (cond) [[unlikely]] {
-        gotoErrorHandler(args...);
-    }
-}
-
-static void gotoErrorHandlerIfErrorOccurred(PyThreadState *tstate) {
-    if (_PyErr_Occurred(tstate)) {
-        gotoErrorHandler(tstate);
-    }
-}
+// Note: Handlers report an exception by returning NULL, or -1 if they return an int.
+// The translated code checks the result and jumps to its error block, which calls handleError.
+struct ErrorResult {
+    operator PyObject *() const { return nullptr; }
 
-static void gotoErrorHandlerIfErrorOccurred() { gotoErrorHandlerIfErrorOccurred(getThreadState()); }
+    operator int() const { return -1; }
+};
 
 static void formatError(PyThreadState *tstate, PyObject *exception, auto value, auto... args) {
     if constexpr (std::is_same_v<decltype(value), const char *>) {
@@ -134,9 +129,9 @@ static void formatError(PyThreadState *tstate, PyObject *exception, auto value,
     } else {
         static_assert(!sizeof...(args));
         if constexpr (std::is_same_v<decltype(value), _Py_Identifier *>) {
-            auto error_obj = _PyUnicode_FromId(value);
-            gotoErrorHandlerIf(!error_obj, tstate);
-            _PyErr_SetObject(tstate, exception, error_obj);
+            if (auto error_obj = _PyUnicode_FromId(value)) {
+                _PyErr_SetObject(tstate, exception, error_obj);
+            }
         } else {
             static_assert(std::is_same_v<decltype(value), PyObject *>);
             _PyErr_SetObject(tstate, exception, value);
@@ -150,25 +145,18 @@ static void formatErrorIfNotOccurred(PyThreadState *tstate, auto... args) {
     }
 }
 
-[[noreturn]] static void formatErrorAndGotoHandler(PyThreadState *tstate, auto... args) {
+static ErrorResult formatErrorAndReturn(PyThreadState *tstate, auto... args) {
     assert(!_PyErr_Occurred(tstate));
     formatError(tstate, args...);
-    gotoErrorHandler(tstate);
+    return {};
 }
 
-[[noreturn]] static void formatErrorAndGotoHandler(PyObject *exception, const char *format, auto... args) {
-    formatErrorAndGotoHandler(getThreadState(), exception, format, args...);
+static ErrorResult formatErrorAndReturn(PyObject *exception, const char *format, auto... args) {
+    return formatErrorAndReturn(getThreadState(), exception, format, args...);
 }
 
-static void formatErrorAndGotoHandlerIf(bool cond, auto... more_args) {
-    if (cond) [[unlikely]] {
-        formatErrorAndGotoHandler(more_args...);
-    }
-}
-
-void handleEvalBreaker() {
-    auto tstate = getThreadState();
-    gotoErrorHandlerIf(eval_frame_handle_pending(tstate), tstate);
+int handleEvalBreaker() {
+    return eval_frame_handle_pending(getThreadState());
 }
 
 void raiseUndefinedName(PyThreadState *tstate, PyObject *name, bool is_free_var) {
@@ -186,7 +174,7 @@ void raiseUndefinedName(PyThreadState *tstate, PyObject *name, bool is_free_var)
     _PyErr_Restore(tstate, type, value, traceback);
 }
 
-[[noreturn]] void raiseUnboundError() {
+void raiseUnboundError() {
     auto tstate = getThreadState();
     const auto &raise_undefined_local_error = [=](PyObject *name) {
         _PyErr_Format(tstate, PyExc_UnboundLocalError,
@@ -215,7 +203,6 @@ void raiseUndefinedName(PyThreadState *tstate, PyObject *name, bool is_free_var)
     } else {
         Py_UNREACHABLE();
     }
-    gotoErrorHandler(tstate);
 }
 
 void handle_ROT_N(PyObject **values, Py_ssize_t n_lift) {
@@ -239,8 +226,8 @@ PyObject *handle_LOAD_CLASSDEREF(PyFrameObject *f, Py_ssize_t index) {
         if (value) {
             Py_INCREF(value);
             return value;
-        } else {
-            gotoErrorHandlerIfErrorOccurred();
+        } else if (PyErr_Occurred()) {
+            return nullptr;
         }
     } else {
         auto value = PyObject_GetItem(locals, name);
@@ -248,7 +235,9 @@ PyObject *handle_LOAD_CLASSDEREF(PyFrameObject *f, Py_ssize_t index) {
             return value;
         } else {
             auto tstate = getThreadState();
-            gotoErrorHandlerIf(!_PyErr_ExceptionMatches(tstate, PyExc_KeyError), tstate);
+            if (!_PyErr_ExceptionMatches(tstate, PyExc_KeyError)) {
+                return nullptr;
+            }
             _PyErr_Clear(tstate);
         }
     }
@@ -257,9 +246,8 @@ PyObject *handle_LOAD_CLASSDEREF(PyFrameObject *f, Py_ssize_t index) {
         Py_INCREF(value);
         return value;
     }
-    auto tstate = getThreadState();
-    raiseUndefinedName(tstate, name, true);
-    gotoErrorHandler(tstate);
+    raiseUndefinedName(getThreadState(), name, true);
+    return nullptr;
 }
 
 PyObject *handle_LOAD_GLOBAL(PyFrameObject *f, PyObject *name, _PyOpcache *co_opcache) {
@@ -269,58 +257,71 @@ PyObject *handle_LOAD_GLOBAL(PyFrameObject *f, PyObject *name, _PyOpcache *co_op
         auto globals = reinterpret_cast<PyDictObject *>(f->f_globals);
         auto builtins = reinterpret_cast<PyDictObject *>(f->f_builtins);
         auto &lg = co_opcache->u.lg;
-        if (co_opcache->optimized > 0) {
+        if (co_opcache->optimized == 1) {
             if (lg.globals_ver == globals->ma_version_tag && lg.builtins_ver == builtins->ma_version_tag) {
                 return Py_NewRef(lg.ptr);
             }
         }
-        auto v = _PyDict_LoadGlobal(globals, builtins, name);
+        Py_ssize_t entry_offset, keys_size;
+        auto v = _PyDict_LoadGlobalEntry(globals, builtins, name, &entry_offset, &keys_size);
         if (!v) {
             auto tstate = getThreadState();
             if (!_PyErr_Occurred(tstate)) {
                 raiseUndefinedName(tstate, name);
             }
-            gotoErrorHandler(tstate);
+            return nullptr;
         }
 
-        co_opcache->optimized = 1;
-        lg.globals_ver = globals->ma_version_tag;
-        lg.builtins_ver = builtins->ma_version_tag;
-        lg.ptr = v;
+        // Note: a value from globals is cached by its dict entry, rebinding any global keeps the cache valid
+        if (entry_offset >= 0) {
+            co_opcache->optimized = 2;
+            lg.ptr = reinterpret_cast<PyObject *>(globals->ma_keys);
+            lg.globals_ver = entry_offset;
+            lg.builtins_ver = keys_size;
+        } else {
+            co_opcache->optimized = 1;
+            lg.globals_ver = globals->ma_version_tag;
+            lg.builtins_ver = builtins->ma_version_tag;
+            lg.ptr = v;
+        }
         return Py_NewRef(v);
     } else {
         if (auto v = PyDict_GetItemWithError(f->f_globals, name)) {
             return Py_NewRef(v);
         }
         auto tstate = getThreadState();
-        gotoErrorHandlerIfErrorOccurred(tstate);
+        if (_PyErr_Occurred(tstate)) {
+            return nullptr;
+        }
         if (auto v = PyObject_GetItem(f->f_builtins, name)) {
             return v;
         }
         if (_PyErr_ExceptionMatches(tstate, PyExc_KeyError)) {
             raiseUndefinedName(tstate, name);
         }
-        gotoErrorHandler(tstate);
+        return nullptr;
     }
 }
 
-void handle_STORE_GLOBAL(PyFrameObject *f, PyObject *name, PyObject *value) {
-    auto err = PyDict_SetItem(f->f_globals, name, value);
-    gotoErrorHandlerIf(err);
+int handle_STORE_GLOBAL(PyFrameObject *f, PyObject *name, PyObject *value) {
+    return PyDict_SetItem(f->f_globals, name, value);
 }
 
-void handle_DELETE_GLOBAL(PyFrameObject *f, PyObject *name) {
+int handle_DELETE_GLOBAL(PyFrameObject *f, PyObject *name) {
     if (PyDict_DelItem(f->f_globals, name)) {
         auto tstate = getThreadState();
         if (_PyErr_ExceptionMatches(tstate, PyExc_KeyError)) {
             raiseUndefinedName(tstate, name);
         }
-        gotoErrorHandler(tstate);
+        return -1;
     }
+    return 0;
 }
 
 PyObject *handle_LOAD_NAME(PyFrameObject *f, PyObject *name) {
-    formatErrorAndGotoHandlerIf(!f->f_locals, PyExc_SystemError, "no locals when loading %R", name);
+    if (!f->f_locals) {
+        return formatErrorAndReturn(PyExc_SystemError, "no locals when loading %R", name);
+    }
 
     PyThreadState *tstate;
     if (PyDict_CheckExact(f->f_locals)) {
@@ -328,14 +329,18 @@ PyObject *handle_LOAD_NAME(PyFrameObject *f, PyObject *name) {
             return Py_NewRef(v);
         } else {
             tstate = getThreadState();
-            gotoErrorHandlerIfErrorOccurred(tstate);
+            if (_PyErr_Occurred(tstate)) {
+                return nullptr;
+            }
         }
     } else {
         if (auto v = PyObject_GetItem(f->f_locals, name)) {
             return v;
         } else {
             tstate = getThreadState();
-            gotoErrorHandlerIf(!_PyErr_ExceptionMatches(tstate, PyExc_KeyError), tstate);
+            if (!_PyErr_ExceptionMatches(tstate, PyExc_KeyError)) {
+                return nullptr;
+            }
             _PyErr_Clear(tstate);
         }
     }
@@ -343,8 +348,8 @@ PyObject *handle_LOAD_NAME(PyFrameObject *f, PyObject *name) {
     assert(PyDict_CheckExact(f->f_globals));
     if (auto v = PyDict_GetItemWithError(f->f_globals, name)) {
         return Py_NewRef(v);
-    } else {
-        gotoErrorHandlerIfErrorOccurred(tstate);
+    } else if (_PyErr_Occurred(tstate)) {
+        return nullptr;
     }
 
     if (PyDict_CheckExact(f->f_builtins)) {
@@ -362,28 +367,30 @@ PyObject *handle_LOAD_NAME(PyFrameObject *f, PyObject *name) {
             raiseUndefinedName(tstate, name);
         }
     }
-    gotoErrorHandler(tstate);
+    return nullptr;
 }
 
-void handle_STORE_NAME(PyFrameObject *f, PyObject *name, PyObject *value) {
-    formatErrorAndGotoHandlerIf(!f->f_locals, PyExc_SystemError, "no locals found when storing %R", name);
-    int err;
+int handle_STORE_NAME(PyFrameObject *f, PyObject *name, PyObject *value) {
+    if (!f->f_locals) {
+        return formatErrorAndReturn(PyExc_SystemError, "no locals found when storing %R", name);
+    }
     if (PyDict_CheckExact(f->f_locals)) {
-        err = PyDict_SetItem(f->f_locals, name, value);
+        return PyDict_SetItem(f->f_locals, name, value);
     } else {
-        err = PyObject_SetItem(f->f_locals, name, value);
+        return PyObject_SetItem(f->f_locals, name, value);
     }
-    gotoErrorHandlerIf(err);
 }
 
-void handle_DELETE_NAME(PyFrameObject *f, PyObject *name) {
+int handle_DELETE_NAME(PyFrameObject *f, PyObject *name) {
     PyObject *ns = f->f_locals;
-    formatErrorAndGotoHandlerIf(!ns, PyExc_SystemError, "no locals when deleting %R", name);
+    if (!ns) {
+        return formatErrorAndReturn(PyExc_SystemError, "no locals when deleting %R", name);
+    }
     if (PyObject_DelItem(ns, name)) {
-        auto tstate = getThreadState();
-        raiseUndefinedName(tstate, name);
-        gotoErrorHandler(tstate);
+        raiseUndefinedName(getThreadState(), name);
+        return -1;
     }
+    return 0;
 }
 
 PyObject *handle_LOAD_ATTR(PyObject *owner, PyObject *name, PyFrameObject *f, _PyOpcache *co_opcache) {
@@ -449,7 +456,9 @@ PyObject *handle_LOAD_ATTR(PyObject *owner, PyObject *name, PyFrameObject *f, _P
         }
 
         if (co_opcache && type->tp_getattro == PyObject_GenericGetAttr) {
-            gotoErrorHandlerIf(!type->tp_dict && !PyType_Ready(type));
+            if (!type->tp_dict && PyType_Ready(type) < 0) {
+                return nullptr;
+            }
             if (auto descr = _PyType_Lookup(type, name)) {
                 if (Py_TYPE(descr) == &PyMemberDescr_Type) {
                     auto dmem = reinterpret_cast<PyMemberDescrObject *>(descr)->d_member;
@@ -491,16 +500,16 @@ PyObject *handle_LOAD_ATTR(PyObject *owner, PyObject *name, PyFrameObject *f, _P
             deopt_opcache();
         }
     }
-    auto value = PyObject_GetAttr(owner, name);
-    gotoErrorHandlerIf(!value);
-    return value;
+    return PyObject_GetAttr(owner, name);
 }
 
-void handle_LOAD_METHOD(PyObject *name, PyObject **sp) {
+int handle_LOAD_METHOD(PyObject *name, PyObject **sp) {
     PyObject *obj = sp[0];
     PyObject *meth = nullptr;
     int meth_found = _PyObject_GetMethod(obj, name, &meth);
-    gotoErrorHandlerIf(!meth);
+    if (!meth) {
+        return -1;
+    }
     if (meth_found) {
         sp[0] = meth;
         sp[1] = obj;
@@ -509,27 +518,24 @@ void handle_LOAD_METHOD(PyObject *name, PyObject **sp) {
         sp[1] = meth;
         Py_DECREF(obj);
     }
+    return 0;
 }
 
-void handle_STORE_ATTR(PyObject *owner, PyObject *name, PyObject *value) {
-    gotoErrorHandlerIf(PyObject_SetAttr(owner, name, value));
+int handle_STORE_ATTR(PyObject *owner, PyObject *name, PyObject *value) {
+    return PyObject_SetAttr(owner, name, value);
 }
 
 // 加速tuple list dict
 PyObject *handle_BINARY_SUBSCR(PyObject *container, PyObject *sub) {
-    auto value = PyObject_GetItem(container, sub);
-    gotoErrorHandlerIf(!value);
-    return value;
+    return PyObject_GetItem(container, sub);
 }
 
-void handle_STORE_SUBSCR(PyObject *container, PyObject *sub, PyObject *value) {
-    auto err = PyObject_SetItem(container, sub, value);
-    gotoErrorHandlerIf(err);
+int handle_STORE_SUBSCR(PyObject *container, PyObject *sub, PyObject *value) {
+    return PyObject_SetItem(container, sub, value);
 }
 
-void handle_DELETE_SUBSCR(PyObject *container, PyObject *sub) {
-    auto err = PyObject_DelItem(container, sub);
-    gotoErrorHandlerIf(err);
+int handle_DELETE_SUBSCR(PyObject *container, PyObject *sub) {
+    return PyObject_DelItem(container, sub);
 }
 
 template <typename T>
@@ -609,7 +615,6 @@ static auto checkSlotCallResult(PyObject *result, PyObject *obj, T PyNumberMetho
                 slot_sign, result ? "succeeded with" : "failed without", Py_TYPE(obj)->tp_name);
     }
 #endif
-    gotoErrorHandlerIf(!result);
     return result;
 }
 
@@ -617,8 +622,10 @@ template <unaryfunc PyNumberMethods::*P, const char *slot_name>
 PyObject *handle_UNARY(PyObject *value) {
     auto type = Py_TYPE(value);
     auto *m = type->tp_as_number;
-    formatErrorAndGotoHandlerIf(!m || !(m->*P), PyExc_TypeError,
-            "bad operand type for unary %s: '%.200s'", getSlotSign(P), type->tp_name);
+    if (!m || !(m->*P)) {
+        return formatErrorAndReturn(PyExc_TypeError,
+                "bad operand type for unary %s: '%.200s'", getSlotSign(P), type->tp_name);
+    }
     return checkSlotCallResult((m->*P)(value), value, P);
 }
 
@@ -630,7 +637,11 @@ PyObject *handle_UNARY_NOT(PyObject *value) {
     if (value == Py_False) {
         return Py_NewRef(Py_True);
     }
-    return Py_NewRef(castPyObjectToBool(value) ? Py_False : Py_True);
+    auto res = castPyObjectToBool(value);
+    if (res < 0) {
+        return nullptr;
+    }
+    return Py_NewRef(res ? Py_False : Py_True);
 }
 
 PyObject *handle_UNARY_POSITIVE(PyObject *value) {
@@ -649,8 +660,8 @@ PyObject *handle_UNARY_INVERT(PyObject *value) {
 }
 
 template <typename T>
-[[noreturn]] static void raiseBinOpTypeError(PyObject *v, PyObject *w, T op_slot, const char *hint = "") {
-    formatErrorAndGotoHandler(PyExc_TypeError,
+static ErrorResult raiseBinOpTypeError(PyObject *v, PyObject *w, T op_slot, const char *hint = "") {
+    return formatErrorAndReturn(PyExc_TypeError,
             "unsupported operand type(s) for %.100s: '%.100s' and '%.100s'%s",
             getSlotSign(op_slot),
             Py_TYPE(v)->tp_name,
@@ -658,7 +669,8 @@ template <typename T>
             hint);
 }
 
-template <bool return_null = false, typename T, typename... Ts>
+// Note: If return_not_implemented, a borrowed Py_NotImplemented is returned instead of raising TypeError
+template <bool return_not_implemented = false, typename T, typename... Ts>
 static PyObject *handleBinary(PyObject *v, PyObject *w, T PyNumberMethods::* op_slot, Ts... more_op_slots) {
     const auto &invoke_slot_func = [&](T func) {
         if constexpr (std::is_same_v<T, ternaryfunc>) {
@@ -712,28 +724,28 @@ static PyObject *handleBinary(PyObject *v, PyObject *w, T PyNumberMethods::* op_
         }
         Py_DECREF(result);
     }
-    if constexpr (return_null) {
-        return nullptr;
+    if constexpr (return_not_implemented) {
+        return Py_NotImplemented;
     } else {
-        raiseBinOpTypeError(v, w, original_op_slot);
+        return raiseBinOpTypeError(v, w, original_op_slot);
     }
 }
 
 PyObject *handle_BINARY_ADD(PyObject *v, PyObject *w) {
     constexpr auto op_slot = &PyNumberMethods::nb_add;
-    if (auto result = handleBinary<true>(v, w, op_slot)) {
+    if (auto result = handleBinary<true>(v, w, op_slot); result != Py_NotImplemented) {
         return result;
     }
     auto m = Py_TYPE(v)->tp_as_sequence;
     if (m && m->sq_concat) {
         return checkSlotCallResult((m->sq_concat)(v, w), v, op_slot);
     }
-    raiseBinOpTypeError(v, w, op_slot);
+    return raiseBinOpTypeError(v, w, op_slot);
 }
 
 PyObject *handle_INPLACE_ADD(PyObject *v, PyObject *w) {
     constexpr auto iop_slot = &PyNumberMethods::nb_inplace_add;
-    if (auto result = handleBinary<true>(v, w, iop_slot, &PyNumberMethods::nb_add)) {
+    if (auto result = handleBinary<true>(v, w, iop_slot, &PyNumberMethods::nb_add); result != Py_NotImplemented) {
         return result;
     }
     auto m = Py_TYPE(v)->tp_as_sequence;
@@ -743,7 +755,7 @@ PyObject *handle_INPLACE_ADD(PyObject *v, PyObject *w) {
             return checkSlotCallResult(func(v, w), v, iop_slot);
         }
     }
-    raiseBinOpTypeError(v, w, iop_slot);
+    return raiseBinOpTypeError(v, w, iop_slot);
 }
 
 PyObject *handle_BINARY_SUBTRACT(PyObject *v, PyObject *w) {
@@ -775,15 +787,17 @@ static PyObject *repeatSequence(PyObject *v, PyObject *w, binaryfunc PyNumberMet
             seq = w;
             n = v;
         } else {
-            raiseBinOpTypeError(v, w, op_slot);
+            return raiseBinOpTypeError(v, w, op_slot);
         }
     }
 
-    formatErrorAndGotoHandlerIf(!_PyIndex_Check(n), PyExc_TypeError,
-            "can't multiply sequence by non-int of type '%.200s'", Py_TYPE(n)->tp_name);
+    if (!_PyIndex_Check(n)) {
+        return formatErrorAndReturn(PyExc_TypeError,
+                "can't multiply sequence by non-int of type '%.200s'", Py_TYPE(n)->tp_name);
+    }
     auto count = PyNumber_AsSsize_t(n, PyExc_OverflowError);
-    if (count == -1) {
-        gotoErrorHandlerIfErrorOccurred();
+    if (count == -1 && PyErr_Occurred()) {
+        return nullptr;
     }
     return checkSlotCallResult(repeat_func(seq, count), seq, op_slot);
 }
@@ -791,7 +805,7 @@ static PyObject *repeatSequence(PyObject *v, PyObject *w, binaryfunc PyNumberMet
 PyObject *handle_BINARY_MULTIPLY(PyObject *v, PyObject *w) {
     constexpr auto op_slot = &PyNumberMethods::nb_multiply;
     auto result = handleBinary<true>(v, w, op_slot);
-    if (result) {
+    if (result != Py_NotImplemented) {
         return result;
     }
     return repeatSequence(v, w, op_slot);
@@ -801,7 +815,7 @@ PyObject *handle_BINARY_MULTIPLY(PyObject *v, PyObject *w) {
 PyObject *handle_INPLACE_MULTIPLY(PyObject *v, PyObject *w) {
     constexpr auto iop_slot = &PyNumberMethods::nb_inplace_multiply;
     auto result = handleBinary<true>(v, w, iop_slot, &PyNumberMethods::nb_multiply);
-    if (result) {
+    if (result != Py_NotImplemented) {
         return result;
     }
     return repeatSequence(v, w, iop_slot);
@@ -826,9 +840,7 @@ PyObject *handle_INPLACE_TRUE_DIVIDE(PyObject *v, PyObject *w) {
 PyObject *handle_BINARY_MODULO(PyObject *v, PyObject *w) {
     if (PyUnicode_CheckExact(v) && (PyUnicode_CheckExact(w) || !PyUnicode_Check(w))) {
         // fast path
-        auto res = PyUnicode_Format(v, w);
-        gotoErrorHandlerIf(!res);
-        return res;
+        return PyUnicode_Format(v, w);
     } else {
         return handleBinary(v, w, &PyNumberMethods::nb_remainder);
     }
@@ -865,13 +877,13 @@ PyObject *handle_INPLACE_LSHIFT(PyObject *v, PyObject *w) {
 PyObject *handle_BINARY_RSHIFT(PyObject *v, PyObject *w) {
     constexpr auto op_slot = &PyNumberMethods::nb_rshift;
     auto result = handleBinary<true>(v, w, op_slot);
-    if (result) {
+    if (result != Py_NotImplemented) {
         return result;
     }
     auto hint = PyCFunction_CheckExact(v)
             && !strcmp("print", reinterpret_cast<PyCFunctionObject *>(v)->m_ml->ml_name) ?
             " Did you mean \"print(<message>, file=<output_stream>)\"?" : "";
-    raiseBinOpTypeError(v, w, op_slot, hint);
+    return raiseBinOpTypeError(v, w, op_slot, hint);
 }
 
 PyObject *handle_INPLACE_RSHIFT(PyObject *v, PyObject *w) {
@@ -910,7 +922,6 @@ PyObject *handle_COMPARE_OP(PyObject *v, PyObject *w, int op) {
 
     if (slot_w && type_v != type_w && PyType_IsSubtype(type_w, type_v)) {
         auto res = slot_w(w, v, _Py_SwappedOp[op]);
-        gotoErrorHandlerIf(!res);
         if (res != Py_NotImplemented) {
             return res;
         }
@@ -919,7 +930,6 @@ PyObject *handle_COMPARE_OP(PyObject *v, PyObject *w, int op) {
     }
     if (slot_v) {
         auto res = slot_v(v, w, op);
-        gotoErrorHandlerIf(!res);
         if (res != Py_NotImplemented) {
             return res;
         }
@@ -927,7 +937,6 @@ PyObject *handle_COMPARE_OP(PyObject *v, PyObject *w, int op) {
     }
     if (slot_w) {
         auto res = slot_w(w, v, _Py_SwappedOp[op]);
-        gotoErrorHandlerIf(!res);
         if (res != Py_NotImplemented) {
             return res;
         }
@@ -938,30 +947,42 @@ PyObject *handle_COMPARE_OP(PyObject *v, PyObject *w, int op) {
     }
 
     static const char *const op_signs[]{"<", "<=", "==", "!=", ">", ">="};
-    formatErrorAndGotoHandler(PyExc_TypeError,
+    return formatErrorAndReturn(PyExc_TypeError,
             "'%s' not supported between instances of '%.100s' and '%.100s'",
             op_signs[op],
             type_v->tp_name,
             type_w->tp_name);
 }
 
-PyObject *handle_CONTAINS_OP(PyObject *value, PyObject *container, bool invert) {
-    auto sqm = Py_TYPE(container)->tp_as_sequence;
+int handle_CONTAINS_OP(PyObject *value, PyObject *container) {
+    auto type = Py_TYPE(container);
+    if (type == &PyDict_Type) {
+        // Note: reuse the cached hash of exact str keys
+        if (PyUnicode_CheckExact(value)) {
+            auto hash = reinterpret_cast<PyASCIIObject *>(value)->hash;
+            if (hash != -1) {
+                return _PyDict_Contains_KnownHash(container, value, hash);
+            }
+        }
+        return PyDict_Contains(container, value);
+    }
+    if (type == &PyUnicode_Type && PyUnicode_CheckExact(value)) {
+        return PyUnicode_Contains(container, value);
+    }
+    // Note: set_contains also handles unhashable set keys, which PySet_Contains does not
+    auto sqm = type->tp_as_sequence;
     Py_ssize_t res;
     if (sqm && sqm->sq_contains) {
         res = sqm->sq_contains(container, value);
     } else {
         res = _PySequence_IterSearch(container, value, PY_ITERSEARCH_CONTAINS);
     }
-    gotoErrorHandlerIf(res < 0);
-    auto res_value = invert ^ (res > 0) ? Py_True : Py_False;
-    Py_INCREF(res_value);
-    return res_value;
+    return res < 0 ? -1 : res > 0;
 }
 
-bool castPyObjectToBool(PyObject *o) {
+int castPyObjectToBool(PyObject *o) {
     if (o == Py_None) {
-        return false;
+        return 0;
     }
     auto type = Py_TYPE(o);
     Py_ssize_t res;
@@ -972,40 +993,84 @@ bool castPyObjectToBool(PyObject *o) {
     } else if (type->tp_as_sequence && type->tp_as_sequence->sq_length) {
         res = type->tp_as_sequence->sq_length(o);
     } else {
-        return true;
+        return 1;
     }
-    gotoErrorHandlerIf(res < 0);
-    return res > 0;
+    return res < 0 ? -1 : res > 0;
 }
 
 PyObject *handle_GET_ITER(PyObject *o) {
     auto type = Py_TYPE(o);
     if (type->tp_iter) {
         auto *res = type->tp_iter(o);
-        gotoErrorHandlerIf(!res);
+        if (!res) {
+            return nullptr;
+        }
         auto res_type = Py_TYPE(res);
         if (res_type->tp_iternext && res_type->tp_iternext != &_PyObject_NextNotImplemented) {
             return res;
         } else {
             PyErr_Format(PyExc_TypeError, "iter() returned non-iterator of type '%.100s'", res_type->tp_name);
             Py_DECREF(res);
-            gotoErrorHandler();
+            return nullptr;
         }
     } else {
         if (!PyDict_Check(o) && type->tp_as_sequence && type->tp_as_sequence->sq_item) {
-            auto res = PySeqIter_New(o);
-            gotoErrorHandlerIf(!res);
-            return res;
+            return PySeqIter_New(o);
+        }
+        return formatErrorAndReturn(PyExc_TypeError, "'%.200s' object is not iterable", type->tp_name);
+    }
+}
+
+// Note: a compiled callee with a trivial body is evaluated in place, its frame is materialized only for the traceback
+static bool callInlinableBody(PyThreadState *tstate, PyObject *func, PyObject *const args[], Py_ssize_t nargs,
+        PyObject *&ret) {
+    if (!Py_IS_TYPE(func, &PyFunction_Type) || tstate->cframe->use_tracing) {
+        return false;
+    }
+    auto co = reinterpret_cast<PyCodeObject *>(PyFunction_GET_CODE(func));
+    if (co->co_argcount != nargs || !hasTranslatedResult(co)) {
+        return false;
+    }
+    auto &body = getTranslatedResult(co).inlinable_body;
+    switch (body.kind) {
+    case InlinableBody::RETURN_LOCAL:
+        ret = Py_NewRef(args[body.operand]);
+        return true;
+    case InlinableBody::RETURN_CONST:
+        ret = Py_NewRef(PyTuple_GET_ITEM(co->co_consts, body.operand));
+        return true;
+    case InlinableBody::RETURN_ATTR:
+        ret = PyObject_GetAttr(args[body.operand], PyTuple_GET_ITEM(co->co_names, body.name));
+        if (!ret) {
+            PyObject *type, *value, *traceback;
+            _PyErr_Fetch(tstate, &type, &value, &traceback);
+            auto f = PyFrame_New(tstate, co, PyFunction_GET_GLOBALS(func), nullptr);
+            _PyErr_Restore(tstate, type, value, traceback);
+            if (f) {
+                for (auto i : IntRange(nargs)) {
+                    f->f_localsplus[i] = Py_NewRef(args[i]);
+                }
+                f->f_lasti = 1;
+                PyTraceBack_Here(f);
+                Py_DECREF(f);
+            }
         }
-        formatErrorAndGotoHandler(PyExc_TypeError, "'%.200s' object is not iterable", type->tp_name);
+        return true;
+    default:
+        return false;
     }
 }
 
-static auto makeFunctionCall(PyObject *func_args[], Py_ssize_t nargs, PyObject *kwnames, Py_ssize_t decref) {
+static PyObject *makeFunctionCall(PyObject *func_args[], Py_ssize_t nargs, PyObject *kwnames, Py_ssize_t decref) {
     auto tstate = getThreadState();
-    auto ret = _PyObject_VectorcallTstate(tstate, func_args[0], func_args + 1,
-            nargs | PY_VECTORCALL_ARGUMENTS_OFFSET, kwnames);
-    gotoErrorHandlerIf(!ret, tstate);
+    PyObject *ret;
+    if (kwnames || !callInlinableBody(tstate, func_args[0], func_args + 1, nargs, ret)) {
+        ret = _PyObject_VectorcallTstate(tstate, func_args[0], func_args + 1,
+                nargs | PY_VECTORCALL_ARGUMENTS_OFFSET, kwnames);
+    }
+    if (!ret) {
+        return nullptr;
+    }
     do {
         Py_DECREF(func_args[decref]);
     } while (decref--);
@@ -1049,22 +1114,25 @@ PyObject *handle_CALL_FUNCTION_EX(PyObject *func, PyObject *args, PyObject *kwar
             auto tstate = getThreadState();
             formatFunctionCallError(tstate, func,
                     "%U argument after * must be an iterable, not %.200s", Py_TYPE(args)->tp_name);
-            gotoErrorHandler(tstate);
+            return nullptr;
         }
         auto t = PySequence_Tuple(args);
-        gotoErrorHandlerIf(!t);
+        if (!t) {
+            return nullptr;
+        }
         ret = PyObject_Call(func, t, kwargs);
         Py_DECREF(t);
     }
     /* Note: tracefunc support here */
-    gotoErrorHandlerIf(!ret);
     return ret;
 }
 
 PyObject *handle_MAKE_FUNCTION(PyObject *codeobj, PyFrameObject *f, PyObject *qualname,
         PyObject **extra, int flag) {
     auto func = reinterpret_cast<PyFunctionObject *>(PyFunction_NewWithQualName(codeobj, f->f_globals, qualname));
-    gotoErrorHandlerIf(!func);
+    if (!func) {
+        return nullptr;
+    }
     if (flag & 0x08) {
         assert(PyTuple_CheckExact(extra[-1]));
         func->func_closure = *--extra;
@@ -1084,21 +1152,48 @@ PyObject *handle_MAKE_FUNCTION(PyObject *codeobj, PyFrameObject *f, PyObject *qu
     return reinterpret_cast<PyObject *>(func);
 }
 
-void handle_FOR_ITER(PyObject *iter) {
+int handle_FOR_ITER(PyObject *iter) {
     auto tstate = getThreadState();
     if (_PyErr_Occurred(tstate)) {
-        gotoErrorHandlerIf(!_PyErr_ExceptionMatches(tstate, PyExc_StopIteration), tstate);
+        if (!_PyErr_ExceptionMatches(tstate, PyExc_StopIteration)) {
+            return -1;
+        }
         /* Note: tracefunc support here */
         _PyErr_Clear(tstate);
     }
     Py_DECREF(iter);
+    return 0;
 }
 
 PyObject *handle_BUILD_STRING(PyObject **arr, Py_ssize_t num) {
-    auto str = PyUnicode_New(0, 0);
-    gotoErrorHandlerIf(!str);
-    str = _PyUnicode_JoinArray(str, arr, num);
-    gotoErrorHandlerIf(!str);
+    if (num == 1 && PyUnicode_CheckExact(arr[0])) {
+        return arr[0];
+    }
+    // Note: the pieces are all str, so the result can be sized up front and written once
+    Py_ssize_t length = 0;
+    Py_UCS4 max_char = 0;
+    for (auto item : PtrRange(arr, num)) {
+        assert(PyUnicode_Check(item));
+        if (PyUnicode_READY(item) < 0) {
+            return nullptr;
+        }
+        auto item_length = PyUnicode_GET_LENGTH(item);
+        if (item_length > PY_SSIZE_T_MAX - length) {
+            return formatErrorAndReturn(PyExc_OverflowError, "join() result is too long for a Python string");
+        }
+        length += item_length;
+        max_char = std::max(max_char, PyUnicode_MAX_CHAR_VALUE(item));
+    }
+    auto str = PyUnicode_New(length, max_char);
+    if (!str) {
+        return nullptr;
+    }
+    Py_ssize_t pos = 0;
+    for (auto item : PtrRange(arr, num)) {
+        auto item_length = PyUnicode_GET_LENGTH(item);
+        _PyUnicode_FastCopyCharacters(str, pos, item, 0, item_length);
+        pos += item_length;
+    }
     while (--num >= 0) {
         Py_DECREF(arr[num]);
     }
@@ -1107,7 +1202,9 @@ PyObject *handle_BUILD_STRING(PyObject **arr, Py_ssize_t num) {
 
 PyObject *handle_BUILD_TUPLE(PyObject **arr, Py_ssize_t num) {
     auto tup = PyTuple_New(num);
-    gotoErrorHandlerIf(!tup);
+    if (!tup) {
+        return nullptr;
+    }
     while (--num >= 0) {
         PyTuple_SET_ITEM(tup, num, arr[num]);
     }
@@ -1116,7 +1213,9 @@ PyObject *handle_BUILD_TUPLE(PyObject **arr, Py_ssize_t num) {
 
 PyObject *handle_BUILD_LIST(PyObject **arr, Py_ssize_t num) {
     auto list = PyList_New(num);
-    gotoErrorHandlerIf(!list);
+    if (!list) {
+        return nullptr;
+    }
     while (--num >= 0) {
         PyList_SET_ITEM(list, num, arr[num]);
     }
@@ -1125,11 +1224,13 @@ PyObject *handle_BUILD_LIST(PyObject **arr, Py_ssize_t num) {
 
 PyObject *handle_BUILD_SET(PyObject **arr, Py_ssize_t num) {
     auto *set = PySet_New(nullptr);
-    gotoErrorHandlerIf(!set);
+    if (!set) {
+        return nullptr;
+    }
     for (auto i = 0; i < num; i++) {
         if (PySet_Add(set, arr[i])) {
             Py_DECREF(set);
-            gotoErrorHandler();
+            return nullptr;
         }
     }
     for (auto i = 0; i < num; i++) {
@@ -1140,11 +1241,13 @@ PyObject *handle_BUILD_SET(PyObject **arr, Py_ssize_t num) {
 
 PyObject *handle_BUILD_MAP(PyObject **arr, Py_ssize_t num) {
     auto map = _PyDict_NewPresized(num);
-    gotoErrorHandlerIf(!map);
+    if (!map) {
+        return nullptr;
+    }
     for (auto i = 0; i < num; i++) {
         if (PyDict_SetItem(map, arr[2 * i], arr[2 * i + 1])) {
             Py_DECREF(map);
-            gotoErrorHandler();
+            return nullptr;
         }
     }
     for (auto i = 0; i < num; i++) {
@@ -1156,14 +1259,17 @@ PyObject *handle_BUILD_MAP(PyObject **arr, Py_ssize_t num) {
 
 PyObject *handle_BUILD_CONST_KEY_MAP(PyObject **arr, Py_ssize_t num) {
     auto keys = arr[num];
-    formatErrorAndGotoHandlerIf(!PyTuple_CheckExact(keys) || PyTuple_GET_SIZE(keys) != num,
-            PyExc_SystemError, "bad BUILD_CONST_KEY_MAP keys argument");
+    if (!PyTuple_CheckExact(keys) || PyTuple_GET_SIZE(keys) != num) {
+        return formatErrorAndReturn(PyExc_SystemError, "bad BUILD_CONST_KEY_MAP keys argument");
+    }
     auto map = _PyDict_NewPresized(num);
-    gotoErrorHandlerIf(!map);
+    if (!map) {
+        return nullptr;
+    }
     for (auto i = 0; i < num; i++) {
         if (PyDict_SetItem(map, PyTuple_GET_ITEM(keys, i), arr[i])) {
             Py_DECREF(map);
-            gotoErrorHandler();
+            return nullptr;
         }
     }
     Py_DECREF(keys);
@@ -1173,23 +1279,23 @@ PyObject *handle_BUILD_CONST_KEY_MAP(PyObject **arr, Py_ssize_t num) {
     return map;
 }
 
-void handle_LIST_APPEND(PyObject *list, PyObject *value) {
-    gotoErrorHandlerIf(PyList_Append(list, value));
+int handle_LIST_APPEND(PyObject *list, PyObject *value) {
+    return PyList_Append(list, value);
 }
 
-void handle_SET_ADD(PyObject *set, PyObject *value) {
-    gotoErrorHandlerIf(PySet_Add(set, value));
+int handle_SET_ADD(PyObject *set, PyObject *value) {
+    return PySet_Add(set, value);
 }
 
-void handle_MAP_ADD(PyObject *map, PyObject *key, PyObject *value) {
-    gotoErrorHandlerIf(PyDict_SetItem(map, key, value));
+int handle_MAP_ADD(PyObject *map, PyObject *key, PyObject *value) {
+    return PyDict_SetItem(map, key, value);
 }
 
-void handle_LIST_EXTEND(PyObject *list, PyObject *iterable) {
+int handle_LIST_EXTEND(PyObject *list, PyObject *iterable) {
     PyObject *none_val = _PyList_Extend((PyListObject *) list, iterable);
     if (none_val) [[likely]] {
         Py_DECREF(none_val);
-        return;
+        return 0;
     }
     auto tstate = getThreadState();
     if (_PyErr_ExceptionMatches(tstate, PyExc_TypeError)
@@ -1199,33 +1305,31 @@ void handle_LIST_EXTEND(PyObject *list, PyObject *iterable) {
                 "Value after * must be an iterable, not %.200s",
                 Py_TYPE(iterable)->tp_name);
     }
-    gotoErrorHandler(tstate);
+    return -1;
 }
 
-void handle_SET_UPDATE(PyObject *set, PyObject *iterable) {
-    gotoErrorHandlerIf(_PySet_Update(set, iterable) < 0);
+int handle_SET_UPDATE(PyObject *set, PyObject *iterable) {
+    return _PySet_Update(set, iterable) < 0 ? -1 : 0;
 }
 
-void handle_DICT_UPDATE(PyObject *dict, PyObject *update) {
+int handle_DICT_UPDATE(PyObject *dict, PyObject *update) {
     if (PyDict_Update(dict, update) >= 0) [[likely]] {
-        return;
+        return 0;
     }
     auto tstate = getThreadState();
     if (_PyErr_ExceptionMatches(tstate, PyExc_AttributeError)) {
         _PyErr_Format(tstate, PyExc_TypeError, "'%.200s' object is not a mapping", Py_TYPE(update)->tp_name);
     }
-    gotoErrorHandler(tstate);
+    return -1;
 }
 
 PyObject *handle_LIST_TO_TUPLE(PyObject *list) {
-    auto tuple = PyList_AsTuple(list);
-    gotoErrorHandlerIf(!tuple);
-    return tuple;
+    return PyList_AsTuple(list);
 }
 
-void handle_DICT_MERGE(PyObject *func, PyObject *dict, PyObject *update) {
+int handle_DICT_MERGE(PyObject *func, PyObject *dict, PyObject *update) {
     if (_PyDict_MergeEx(dict, update, 2) == 0) [[likely]] {
-        return;
+        return 0;
     }
     auto tstate = getThreadState();
     if (_PyErr_ExceptionMatches(tstate, PyExc_AttributeError)) {
@@ -1240,7 +1344,7 @@ void handle_DICT_MERGE(PyObject *func, PyObject *dict, PyObject *update) {
             Py_DECREF(key);
         }
     }
-    gotoErrorHandler(tstate);
+    return -1;
 }
 
 PyObject *handle_FORMAT_VALUE(PyObject *value, PyObject *fmt_spec, int which_conversion) {
@@ -1249,79 +1353,118 @@ PyObject *handle_FORMAT_VALUE(PyObject *value, PyObject *fmt_spec, int which_con
         Py_INCREF(value);
         break;
     case FVC_STR:
-        gotoErrorHandlerIf(!(value = PyObject_Str(value)));
+        value = PyObject_Str(value);
         break;
     case FVC_REPR:
-        gotoErrorHandlerIf(!(value = PyObject_Repr(value)));
+        value = PyObject_Repr(value);
         break;
     case FVC_ASCII:
-        gotoErrorHandlerIf(!(value = PyObject_ASCII(value)));
+        value = PyObject_ASCII(value);
         break;
     default: {
-        formatErrorAndGotoHandler(PyExc_SystemError, "unexpected conversion flag %d", which_conversion);
+        return formatErrorAndReturn(PyExc_SystemError, "unexpected conversion flag %d", which_conversion);
     }
     }
+    if (!value) {
+        return nullptr;
+    }
 
     if (!fmt_spec && PyUnicode_CheckExact(value)) {
         return value;
     }
-    auto fmt_value = PyObject_Format(value, fmt_spec);
+    PyObject *fmt_value;
+    if (PyLong_CheckExact(value) || PyFloat_CheckExact(value)) {
+        // Note: bypass the lookup and call of __format__, as long__format__ and float__format__ do
+        if (!fmt_spec || !PyUnicode_GET_LENGTH(fmt_spec)) {
+            fmt_value = Py_TYPE(value)->tp_repr(value);
+        } else {
+            _PyUnicodeWriter writer;
+            _PyUnicodeWriter_Init(&writer);
+            auto spec_length = PyUnicode_GET_LENGTH(fmt_spec);
+            auto ret = PyLong_CheckExact(value)
+                    ? _PyLong_FormatAdvancedWriter(&writer, value, fmt_spec, 0, spec_length)
+                    : _PyFloat_FormatAdvancedWriter(&writer, value, fmt_spec, 0, spec_length);
+            if (ret < 0) {
+                _PyUnicodeWriter_Dealloc(&writer);
+                fmt_value = nullptr;
+            } else {
+                fmt_value = _PyUnicodeWriter_Finish(&writer);
+            }
+        }
+    } else {
+        fmt_value = PyObject_Format(value, fmt_spec);
+    }
     Py_DECREF(value);
-    gotoErrorHandlerIf(!fmt_value);
     return fmt_value;
 }
 
 PyObject *handle_BUILD_SLICE(PyObject *start, PyObject *stop, PyObject *step) {
-    auto slice = PySlice_New(start, stop, step);
-    gotoErrorHandlerIf(!slice);
-    return slice;
+    return PySlice_New(start, stop, step);
 }
 
-void handle_SETUP_ANNOTATIONS(PyFrameObject *f) {
+int handle_SETUP_ANNOTATIONS(PyFrameObject *f) {
     _Py_IDENTIFIER(__annotations__);
-    formatErrorAndGotoHandlerIf(!f->f_locals, PyExc_SystemError, "no locals found when setting up annotations");
+    if (!f->f_locals) {
+        return formatErrorAndReturn(PyExc_SystemError, "no locals found when setting up annotations");
+    }
     /* check if __annotations__ in locals()... */
     if (PyDict_CheckExact(f->f_locals)) {
         auto ann_dict = _PyDict_GetItemIdWithError(f->f_locals, &PyId___annotations__);
         if (!ann_dict) {
-            gotoErrorHandlerIfErrorOccurred();
+            if (PyErr_Occurred()) {
+                return -1;
+            }
             /* ...if not, create a new one */
             ann_dict = PyDict_New();
-            gotoErrorHandlerIf(!ann_dict);
+            if (!ann_dict) {
+                return -1;
+            }
             auto err = _PyDict_SetItemId(f->f_locals, &PyId___annotations__, ann_dict);
             Py_DECREF(ann_dict);
-            gotoErrorHandlerIf(err);
+            return err;
         }
     } else {
         /* do the same if locals() is not a dict */
         PyObject *ann_str = _PyUnicode_FromId(&PyId___annotations__);
-        gotoErrorHandlerIf(!ann_str);
+        if (!ann_str) {
+            return -1;
+        }
         auto ann_dict = PyObject_GetItem(f->f_locals, ann_str);
         if (!ann_dict) {
             auto tstate = getThreadState();
-            gotoErrorHandlerIf(!_PyErr_ExceptionMatches(tstate, PyExc_KeyError));
+            if (!_PyErr_ExceptionMatches(tstate, PyExc_KeyError)) {
+                return -1;
+            }
             _PyErr_Clear(tstate);
             ann_dict = PyDict_New();
-            gotoErrorHandlerIf(!ann_dict);
+            if (!ann_dict) {
+                return -1;
+            }
             auto err = PyObject_SetItem(f->f_locals, ann_str, ann_dict);
             Py_DECREF(ann_dict);
-            gotoErrorHandlerIf(err);
+            return err;
         } else {
             Py_DECREF(ann_dict);
         }
     }
+    return 0;
 }
 
-void handle_PRINT_EXPR(PyObject *value) {
+int handle_PRINT_EXPR(PyObject *value) {
     _Py_IDENTIFIER(displayhook);
     PyObject *hook = _PySys_GetObjectId(&PyId_displayhook);
-    formatErrorAndGotoHandlerIf(!hook, PyExc_RuntimeError, "lost sys.displayhook");
+    if (!hook) {
+        return formatErrorAndReturn(PyExc_RuntimeError, "lost sys.displayhook");
+    }
     auto res = PyObject_CallOneArg(hook, value);
-    gotoErrorHandlerIf(!res);
+    if (!res) {
+        return -1;
+    }
     Py_DECREF(res);
+    return 0;
 }
 
-void handle_UNPACK_SEQUENCE(PyObject *seq, Py_ssize_t num, PyObject **dest) {
+int handle_UNPACK_SEQUENCE(PyObject *seq, Py_ssize_t num, PyObject **dest) {
     if (PyTuple_CheckExact(seq) && PyTuple_GET_SIZE(seq) == num) {
         auto items = (reinterpret_cast<PyTupleObject *>(seq))->ob_item;
         while (num--) {
@@ -1337,11 +1480,12 @@ void handle_UNPACK_SEQUENCE(PyObject *seq, Py_ssize_t num, PyObject **dest) {
             *dest++ = item;
         }
     } else {
-        handle_UNPACK_EX(seq, num, -1, dest);
+        return handle_UNPACK_EX(seq, num, -1, dest);
     }
+    return 0;
 }
 
-void handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_star, PyObject **dest) {
+int handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_star, PyObject **dest) {
     assert(seq);
     auto old_stack_value = *dest;
     auto ptr_end = dest + (before_star + 1 + after_star);
@@ -1354,9 +1498,9 @@ void handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_st
             Py_DECREF(*ptr++);
         }
         // Note: The value on the stack may have been overwritten, we should restore it.
-        // Otherwise, gotoErrorHandler will Py_DECREF the wrong value.
+        // Otherwise, handleError will Py_DECREF the wrong value.
         *dest = old_stack_value;
-        gotoErrorHandler(tstate);
+        return -1;
     };
 
     if (!iter) {
@@ -1365,7 +1509,7 @@ void handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_st
                     "cannot unpack non-iterable %.200s object",
                     Py_TYPE(seq)->tp_name);
         }
-        gotoErrorHandler();
+        return -1;
     }
 
     for (int i = 0; i < before_star; i++) {
@@ -1379,7 +1523,7 @@ void handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_st
                 after_star == -1 ? "" : "at least ",
                 after_star == -1 ? before_star : before_star + after_star,
                 i);
-        clear_and_exit();
+        return clear_and_exit();
     }
 
     if (after_star == -1) {
@@ -1388,18 +1532,18 @@ void handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_st
         if (w) {
             Py_DECREF(w);
             _PyErr_Format(tstate, PyExc_ValueError, "too many values to unpack (expected %d)", before_star);
-            clear_and_exit();
+            return clear_and_exit();
         }
         if (_PyErr_Occurred(tstate)) {
-            clear_and_exit();
+            return clear_and_exit();
         }
         Py_DECREF(iter);
-        return;
+        return 0;
     }
 
     auto l = PySequence_List(iter);
     if (!l) {
-        clear_and_exit();
+        return clear_and_exit();
     }
     *--ptr = l;
 
@@ -1408,7 +1552,7 @@ void handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_st
         _PyErr_Format(tstate, PyExc_ValueError,
                 "not enough values to unpack (expected at least %d, got %zd)",
                 before_star + after_star, before_star + list_size);
-        clear_and_exit();
+        return clear_and_exit();
     }
 
     /* Pop the "after-variable" args off the list. */
@@ -1418,41 +1562,46 @@ void handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_st
     /* Resize the list. */
     Py_SET_SIZE(l, list_size - after_star);
     Py_DECREF(iter);
+    return 0;
 }
 
 PyObject *hanlde_GET_LEN(PyObject *value) {
     auto len_i = PyObject_Length(value);
-    gotoErrorHandlerIf(len_i < 0);
-    auto len_o = PyLong_FromSsize_t(len_i);
-    gotoErrorHandlerIf(!len_o);
-    return len_o;
+    if (len_i < 0) {
+        return nullptr;
+    }
+    return PyLong_FromSsize_t(len_i);
 }
 
-void hanlde_MATCH_KEYS(PyObject **inputs_outputs) {
+int hanlde_MATCH_KEYS(PyObject **inputs_outputs) {
     auto keys = inputs_outputs[-1];
     auto map = inputs_outputs[-2];
     auto nkeys = PyTuple_GET_SIZE(keys);
     if (!nkeys) {
         auto empty_tuple = PyTuple_New(0);
-        gotoErrorHandlerIf(!empty_tuple);
+        if (!empty_tuple) {
+            return -1;
+        }
         inputs_outputs[0] = empty_tuple;
         inputs_outputs[1] = Py_NewRef(Py_True);
-        return;
+        return 0;
     }
 
     _Py_IDENTIFIER(get);
     auto get = _PyObject_GetAttrId(map, &PyId_get);
-    gotoErrorHandlerIf(!get);
+    if (!get) {
+        return -1;
+    }
     auto seen = PySet_New(nullptr);
     if (!seen) {
         Py_DECREF(get);
-        gotoErrorHandler();
+        return -1;
     }
     auto values = PyList_New(0);
-    if (!seen) {
+    if (!values) {
         Py_DECREF(get);
         Py_DECREF(seen);
-        gotoErrorHandler();
+        return -1;
     }
 
     const auto &do_match = [=]() -> PyObject * {
@@ -1486,17 +1635,22 @@ void hanlde_MATCH_KEYS(PyObject **inputs_outputs) {
     Py_DECREF(get);
     Py_DECREF(seen);
     Py_DECREF(values);
-    gotoErrorHandlerIf(!result);
+    if (!result) {
+        return -1;
+    }
     inputs_outputs[0] = result;
     inputs_outputs[1] = Py_NewRef(result != Py_None ? Py_True : Py_False);
+    return 0;
 }
 
-void hanlde_MATCH_CLASS(Py_ssize_t nargs, PyObject *kwargs, PyObject **inputs_outputs) {
+int hanlde_MATCH_CLASS(Py_ssize_t nargs, PyObject *kwargs, PyObject **inputs_outputs) {
     auto subject = inputs_outputs[0];
     auto type = inputs_outputs[1];
     auto type_ = reinterpret_cast<PyTypeObject *>(type);
 
-    formatErrorAndGotoHandlerIf(!PyType_Check(type), PyExc_TypeError, "called match pattern must be a type");
+    if (!PyType_Check(type)) {
+        return formatErrorAndReturn(PyExc_TypeError, "called match pattern must be a type");
+    }
 
     PyObject *seen = nullptr;
     PyObject *attrs = nullptr;
@@ -1605,7 +1759,9 @@ void hanlde_MATCH_CLASS(Py_ssize_t nargs, PyObject *kwargs, PyObject **inputs_ou
         Py_XDECREF(seen);
         Py_XDECREF(attrs);
         Py_XDECREF(match_args);
-        gotoErrorHandlerIfErrorOccurred();
+        if (PyErr_Occurred()) {
+            return -1;
+        }
         inputs_outputs[1] = Py_NewRef(Py_False);
         Py_DECREF(type);
     } else {
@@ -1616,20 +1772,23 @@ void hanlde_MATCH_CLASS(Py_ssize_t nargs, PyObject *kwargs, PyObject **inputs_ou
         Py_DECREF(subject);
         Py_DECREF(type);
     }
+    return 0;
 }
 
 PyObject *handle_COPY_DICT_WITHOUT_KEYS(PyObject *subject, PyObject *keys) {
     PyObject *rest = PyDict_New();
-    gotoErrorHandlerIf(!rest);
+    if (!rest) {
+        return nullptr;
+    }
     if (PyDict_Update(rest, subject)) {
         Py_DECREF(rest);
-        gotoErrorHandler();
+        return nullptr;
     }
     assert(PyTuple_CheckExact(keys));
     for (auto i : IntRange(PyTuple_GET_SIZE(keys))) {
         if (PyDict_DelItem(rest, PyTuple_GET_ITEM(keys, i))) {
             Py_DECREF(rest);
-            gotoErrorHandler();
+            return nullptr;
         }
     }
     return rest;
@@ -1639,7 +1798,9 @@ PyObject *handle_COPY_DICT_WITHOUT_KEYS(PyObject *subject, PyObject *keys) {
 PyObject *handle_LOAD_BUILD_CLASS(PyFrameObject *f) {
     _Py_IDENTIFIER(__build_class__);
     PyObject *build_class_str = _PyUnicode_FromId(&PyId___build_class__);
-    gotoErrorHandlerIf(!build_class_str);
+    if (!build_class_str) {
+        return nullptr;
+    }
 
     auto builtins = f->f_builtins;
     static const char error_message[]{"__build_class__ not found"};
@@ -1650,9 +1811,8 @@ PyObject *handle_LOAD_BUILD_CLASS(PyFrameObject *f) {
             Py_INCREF(bc);
             return bc;
         }
-        auto tstate = getThreadState();
-        formatErrorIfNotOccurred(tstate, PyExc_NameError, error_message);
-        gotoErrorHandler(tstate);
+        formatErrorIfNotOccurred(getThreadState(), PyExc_NameError, error_message);
+        return nullptr;
     } else {
         auto bc = PyObject_GetItem(builtins, build_class_str);
         if (bc) {
@@ -1662,56 +1822,57 @@ PyObject *handle_LOAD_BUILD_CLASS(PyFrameObject *f) {
         if (_PyErr_ExceptionMatches(tstate, PyExc_KeyError)) {
             _PyErr_SetString(tstate, PyExc_NameError, error_message);
         }
-        gotoErrorHandler(tstate);
+        return nullptr;
     }
 }
 
 PyObject *handle_IMPORT_NAME(PyFrameObject *f, PyObject *name, PyObject *fromlist, PyObject *level) {
-    auto tstate = getThreadState();
-    auto res = import_name(tstate, f, name, fromlist, level);
-    gotoErrorHandlerIf(!res, tstate);
-    return res;
+    return import_name(getThreadState(), f, name, fromlist, level);
 }
 
 PyObject *handle_IMPORT_FROM(PyObject *from, PyObject *name) {
-    auto tstate = getThreadState();
-    auto res = import_from(tstate, from, name);
-    gotoErrorHandlerIf(!res, tstate);
-    return res;
+    return import_from(getThreadState(), from, name);
 }
 
-void handle_IMPORT_STAR(PyFrameObject *f, PyObject *from) {
-    gotoErrorHandlerIf(PyFrame_FastToLocalsWithError(f) < 0);
+int handle_IMPORT_STAR(PyFrameObject *f, PyObject *from) {
+    if (PyFrame_FastToLocalsWithError(f) < 0) {
+        return -1;
+    }
     auto tstate = getThreadState();
-    formatErrorAndGotoHandlerIf(!f->f_locals, tstate, PyExc_SystemError, "no locals found during 'import *'");
+    if (!f->f_locals) {
+        return formatErrorAndReturn(tstate, PyExc_SystemError, "no locals found during 'import *'");
+    }
     auto err = import_all_from(tstate, f->f_locals, from);
     PyFrame_LocalsToFast(f, 0);
-    gotoErrorHandlerIf(err, tstate);
+    return err;
 }
 
-void handle_POP_EXCEPT(PyFrameObject *f, PyObject **exc_triple) {
+int handle_POP_EXCEPT(PyFrameObject *f, PyObject **exc_triple) {
     auto tstate = getThreadState();
-    formatErrorAndGotoHandlerIf(PyFrame_BlockPop(f)->b_type != EXCEPT_HANDLER,
-            tstate, PyExc_SystemError, "popped block is not an except handler");
+    if (PyFrame_BlockPop(f)->b_type != EXCEPT_HANDLER) {
+        return formatErrorAndReturn(tstate, PyExc_SystemError, "popped block is not an except handler");
+    }
     restoreExcInfo(tstate, exc_triple);
+    return 0;
 }
 
-bool handle_JUMP_IF_NOT_EXC_MATCH(PyObject *left, PyObject *right) {
+int handle_JUMP_IF_NOT_EXC_MATCH(PyObject *left, PyObject *right) {
     static char CANNOT_CATCH_MSG[]{"catching classes that do not inherit from BaseException is not allowed"};
     if (PyTuple_Check(right)) {
         for (auto i = PyTuple_GET_SIZE(right); i--;) {
             auto exc = PyTuple_GET_ITEM(right, i);
-            formatErrorAndGotoHandlerIf(!PyExceptionClass_Check(exc), PyExc_TypeError, CANNOT_CATCH_MSG);
+            if (!PyExceptionClass_Check(exc)) {
+                return formatErrorAndReturn(PyExc_TypeError, CANNOT_CATCH_MSG);
+            }
         }
-    } else {
-        formatErrorAndGotoHandlerIf(!PyExceptionClass_Check(right), PyExc_TypeError, CANNOT_CATCH_MSG);
+    } else if (!PyExceptionClass_Check(right)) {
+        return formatErrorAndReturn(PyExc_TypeError, CANNOT_CATCH_MSG);
     }
     auto res = PyErr_GivenExceptionMatches(left, right);
-    gotoErrorHandlerIf(res < 0);
-    return res > 0;
+    return res < 0 ? -1 : res > 0;
 }
 
-[[noreturn]] void handle_RERAISE(bool restore_lasti, int stack_height) {
+bool handle_RERAISE(bool restore_lasti, int stack_height) {
     auto tstate = getThreadState();
     auto f = tstate->frame;
     assert(f->f_iblock > 0);
@@ -1720,10 +1881,10 @@ bool handle_JUMP_IF_NOT_EXC_MATCH(PyObject *left, PyObject *right) {
     }
     auto sp = &f->f_valuestack[stack_height -= 3];
     _PyErr_Restore(tstate, sp[2], sp[1], sp[0]);
-    unwindFrame(tstate, stack_height);
+    return unwindFrame(tstate, stack_height);
 }
 
-void handle_SETUP_WITH(PyFrameObject *f, int handler, int stack_height) {
+int handle_SETUP_WITH(PyFrameObject *f, int handler, int stack_height) {
     _Py_IDENTIFIER(__enter__);
     _Py_IDENTIFIER(__exit__);
 
@@ -1731,35 +1892,34 @@ void handle_SETUP_WITH(PyFrameObject *f, int handler, int stack_height) {
     auto mgr = sp[-1];
     auto enter = _PyObject_LookupSpecial(mgr, &PyId___enter__);
     if (!enter) {
-        auto tstate = getThreadState();
-        formatErrorIfNotOccurred(tstate, PyExc_AttributeError, &PyId___enter__);
-        gotoErrorHandler(tstate);
+        formatErrorIfNotOccurred(getThreadState(), PyExc_AttributeError, &PyId___enter__);
+        return -1;
     }
 
     auto exit = _PyObject_LookupSpecial(mgr, &PyId___exit__);
     if (!exit) {
-        auto tstate = getThreadState();
-        formatErrorIfNotOccurred(tstate, PyExc_AttributeError, &PyId___exit__);
+        formatErrorIfNotOccurred(getThreadState(), PyExc_AttributeError, &PyId___exit__);
         Py_DECREF(enter);
-        gotoErrorHandler(tstate);
+        return -1;
     }
     sp[-1] = exit;
     Py_DECREF(mgr);
     auto res = _PyObject_CallNoArg(enter);
     Py_DECREF(enter);
-    gotoErrorHandlerIf(!res);
+    if (!res) {
+        return -1;
+    }
     PyFrame_BlockSetup(f, SETUP_FINALLY, handler, stack_height);
     sp[0] = res;
+    return 0;
 }
 
 PyObject *handle_WITH_EXCEPT_START(PyObject **stack_top) {
     PyObject *args[4] = {nullptr, stack_top[-1], stack_top[-2], stack_top[-3]};
-    auto res = PyObject_Vectorcall(stack_top[-7], &args[1], 3 | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr);
-    gotoErrorHandlerIf(!res);
-    return res;
+    return PyObject_Vectorcall(stack_top[-7], &args[1], 3 | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr);
 }
 
-[[noreturn]] void handle_RAISE_VARARGS(int argc, int stack_height) {
+bool handle_RAISE_VARARGS(int argc, int stack_height) {
     auto tstate = getThreadState();
     auto sp = &tstate->frame->f_valuestack[stack_height - argc];
     PyObject *exc = nullptr;
@@ -1773,43 +1933,47 @@ PyObject *handle_WITH_EXCEPT_START(PyObject **stack_top) {
         }
     }
     if (do_raise(tstate, exc, cause)) {
-        unwindFrame(tstate, stack_height);
+        return unwindFrame(tstate, stack_height);
     }
-    gotoErrorHandler(tstate);
+    return handleError();
 }
 
 PyObject *handle_YIELD_VALUE(PyObject *val) {
     PyObject *w = _PyAsyncGenValueWrapperNew(val);
-    gotoErrorHandlerIf(!w);
+    if (!w) {
+        return nullptr;
+    }
     Py_DECREF(val);
     return w;
 }
 
-PyObject *handle_YIELD_FROM(PyObject **inputs_outputs) {
+int handle_YIELD_FROM(PyObject **inputs_outputs) {
     auto receiver = inputs_outputs[0];
     auto arg = inputs_outputs[1];
     PyObject *value;
     auto gen_status = PyIter_Send(receiver, arg, &value);
     /* Note: tracefunc support here */
-    gotoErrorHandlerIf(gen_status == PYGEN_ERROR);
+    if (gen_status == PYGEN_ERROR) {
+        return PYGEN_ERROR;
+    }
     Py_DECREF(arg);
     if (gen_status == PYGEN_RETURN) {
         inputs_outputs[0] = value;
         Py_DECREF(receiver);
-        return nullptr;
     } else {
-        return value;
+        inputs_outputs[1] = value;
     }
+    return gen_status;
 }
 
 PyObject *handle_GET_YIELD_FROM_ITER(PyObject *iterable, bool is_coroutine) {
     if (PyCoro_CheckExact(iterable)) {
-        formatErrorAndGotoHandlerIf(!is_coroutine, PyExc_TypeError,
-                "cannot 'yield from' a coroutine object in a non-coroutine generator");
+        if (!is_coroutine) {
+            return formatErrorAndReturn(PyExc_TypeError,
+                    "cannot 'yield from' a coroutine object in a non-coroutine generator");
+        }
     } else if (!PyGen_CheckExact(iterable)) {
-        auto iter = PyObject_GetIter(iterable);
-        gotoErrorHandlerIf(!iter);
-        return iter;
+        return PyObject_GetIter(iterable);
     }
     Py_INCREF(iterable);
     return iterable;
@@ -1818,9 +1982,8 @@ PyObject *handle_GET_YIELD_FROM_ITER(PyObject *iterable, bool is_coroutine) {
 PyObject *handle_GET_AWAITABLE(PyObject *iterable, int prev_prev_op, int prev_op) {
     auto iter = _PyCoro_GetAwaitableIter(iterable);
     if (!iter) {
-        auto tstate = getThreadState();
-        format_awaitable_error(tstate, Py_TYPE(iterable), prev_prev_op, prev_op);
-        gotoErrorHandler(tstate);
+        format_awaitable_error(getThreadState(), Py_TYPE(iterable), prev_prev_op, prev_op);
+        return nullptr;
     }
 
     if (PyCoro_CheckExact(iter)) {
@@ -1828,7 +1991,7 @@ PyObject *handle_GET_AWAITABLE(PyObject *iterable, int prev_prev_op, int prev_op
         if (yf) {
             Py_DECREF(yf);
             Py_DECREF(iter);
-            formatErrorAndGotoHandler(PyExc_RuntimeError, "coroutine is being awaited already");
+            return formatErrorAndReturn(PyExc_RuntimeError, "coroutine is being awaited already");
         }
     }
     return iter;
@@ -1836,21 +1999,24 @@ PyObject *handle_GET_AWAITABLE(PyObject *iterable, int prev_prev_op, int prev_op
 
 PyObject *handle_GET_AITER(PyObject *obj) {
     PyTypeObject *type = Py_TYPE(obj);
-    formatErrorAndGotoHandlerIf(!type->tp_as_async || !type->tp_as_async->am_aiter, PyExc_TypeError,
-            "'async for' requires an object with __aiter__ method, got %.100s",
-            type->tp_name);
+    if (!type->tp_as_async || !type->tp_as_async->am_aiter) {
+        return formatErrorAndReturn(PyExc_TypeError,
+                "'async for' requires an object with __aiter__ method, got %.100s",
+                type->tp_name);
+    }
 
     auto iter = type->tp_as_async->am_aiter(obj);
-    gotoErrorHandlerIf(!iter);
+    if (!iter) {
+        return nullptr;
+    }
     auto iter_type = Py_TYPE(iter);
 
     if (!iter_type->tp_as_async || !iter_type->tp_as_async->am_anext) {
-        auto tstate = getThreadState();
-        _PyErr_Format(tstate, PyExc_TypeError,
+        _PyErr_Format(getThreadState(), PyExc_TypeError,
                 "'async for' received an object from __aiter__ that does not implement __anext__: %.100s",
                 iter_type->tp_name);
         Py_DECREF(iter);
-        gotoErrorHandler(tstate);
+        return nullptr;
     }
     return iter;
 }
@@ -1858,29 +2024,32 @@ PyObject *handle_GET_AITER(PyObject *obj) {
 PyObject *handle_GET_ANEXT(PyObject *aiter) {
     PyTypeObject *type = Py_TYPE(aiter);
     if (PyAsyncGen_CheckExact(aiter)) {
-        auto awaitable = type->tp_as_async->am_anext(aiter);
-        gotoErrorHandlerIf(!awaitable);
-        return awaitable;
+        return type->tp_as_async->am_anext(aiter);
     } else {
-        formatErrorAndGotoHandlerIf(!type->tp_as_async || !type->tp_as_async->am_anext, PyExc_TypeError,
-                "'async for' requires an iterator with __anext__ method, got %.100s",
-                type->tp_name);
+        if (!type->tp_as_async || !type->tp_as_async->am_anext) {
+            return formatErrorAndReturn(PyExc_TypeError,
+                    "'async for' requires an iterator with __anext__ method, got %.100s",
+                    type->tp_name);
+        }
         auto next_iter = type->tp_as_async->am_anext(aiter);
-        gotoErrorHandlerIf(!next_iter);
+        if (!next_iter) {
+            return nullptr;
+        }
 
         auto awaitable = _PyCoro_GetAwaitableIter(next_iter);
         if (!awaitable) {
             _PyErr_FormatFromCause(PyExc_TypeError, "'async for' received an invalid object from __anext__: %.100s",
                     Py_TYPE(next_iter)->tp_name);
             Py_DECREF(next_iter);
-            gotoErrorHandler();
+            return nullptr;
         }
         Py_DECREF(next_iter);
         return awaitable;
     }
 }
 
-void handle_END_ASYNC_FOR(int stack_height) {
+// Note: If the exception is not StopAsyncIteration, it should be re-raised by handle_RERAISE
+bool handle_END_ASYNC_FOR(int stack_height) {
     auto tstate = getThreadState();
     auto f = tstate->frame;
     if (PyErr_GivenExceptionMatches(f->f_valuestack[stack_height - 1], PyExc_StopAsyncIteration)) {
@@ -1889,36 +2058,35 @@ void handle_END_ASYNC_FOR(int stack_height) {
         clearStack(f, stack_height, b->b_level + 3);
         restoreExcInfo(tstate, &f->f_valuestack[stack_height -= 3]);
         Py_DECREF(f->f_valuestack[--stack_height]);
-    } else {
-        auto sp = &f->f_valuestack[stack_height -= 3];
-        _PyErr_Restore(tstate, sp[2], sp[1], sp[0]);
-        unwindFrame(tstate, stack_height);
+        return true;
     }
+    return false;
 }
 
-void handle_BEFORE_ASYNC_WITH(PyObject **sp) {
+int handle_BEFORE_ASYNC_WITH(PyObject **sp) {
     _Py_IDENTIFIER(__aenter__);
     _Py_IDENTIFIER(__aexit__);
 
     auto mgr = *--sp;
     auto enter = _PyObject_LookupSpecial(mgr, &PyId___aenter__);
     if (!enter) {
-        auto tstate = getThreadState();
-        formatErrorIfNotOccurred(tstate, PyExc_AttributeError, &PyId___aenter__);
-        gotoErrorHandler(tstate);
+        formatErrorIfNotOccurred(getThreadState(), PyExc_AttributeError, &PyId___aenter__);
+        return -1;
     }
 
     auto exit = _PyObject_LookupSpecial(mgr, &PyId___aexit__);
     if (!exit) {
-        auto tstate = getThreadState();
-        formatErrorIfNotOccurred(tstate, PyExc_AttributeError, &PyId___aexit__);
+        formatErrorIfNotOccurred(getThreadState(), PyExc_AttributeError, &PyId___aexit__);
         Py_DECREF(enter);
-        gotoErrorHandler(tstate);
+        return -1;
     }
     *sp++ = exit;
     Py_DECREF(mgr);
     auto res = _PyObject_CallNoArg(enter);
     Py_DECREF(enter);
-    gotoErrorHandlerIf(!res);
+    if (!res) {
+        return -1;
+    }
     *sp++ = res;
+    return 0;
 }
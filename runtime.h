@@ -1,8 +1,6 @@
 #ifndef COMPYLER_SHARED_SYMBOLS
 #define COMPYLER_SHARED_SYMBOLS
 
-#include <csetjmp>
-
 #include <Python.h>
 #undef HAVE_STD_ATOMIC
 #include <frameobject.h>
@@ -12,23 +10,24 @@
 #include "common.h"
 
 void raiseUndefinedName(PyThreadState *tstate, PyObject *name, bool is_free_var = false);
-[[noreturn]] void raiseUnboundError();
+void raiseUnboundError();
+bool handleError();
 
 void handle_ROT_N(PyObject **values, Py_ssize_t n_lift);
 
 PyObject *handle_LOAD_CLASSDEREF(PyFrameObject *f, Py_ssize_t index);
 PyObject *handle_LOAD_GLOBAL(PyFrameObject *f, PyObject *name, _PyOpcache *co_opcache);
-void handle_STORE_GLOBAL(PyFrameObject *f, PyObject *name, PyObject *value);
-void handle_DELETE_GLOBAL(PyFrameObject *f, PyObject *name);
+int handle_STORE_GLOBAL(PyFrameObject *f, PyObject *name, PyObject *value);
+int handle_DELETE_GLOBAL(PyFrameObject *f, PyObject *name);
 PyObject *handle_LOAD_NAME(PyFrameObject *f, PyObject *name);
-void handle_STORE_NAME(PyFrameObject *f, PyObject *name, PyObject *value);
-void handle_DELETE_NAME(PyFrameObject *f, PyObject *name);
+int handle_STORE_NAME(PyFrameObject *f, PyObject *name, PyObject *value);
+int handle_DELETE_NAME(PyFrameObject *f, PyObject *name);
 PyObject *handle_LOAD_ATTR(PyObject *owner, PyObject *name, PyFrameObject *f, _PyOpcache *co_opcache);
-void handle_LOAD_METHOD(PyObject *name, PyObject **sp);
-void handle_STORE_ATTR(PyObject *owner, PyObject *name, PyObject *value);
+int handle_LOAD_METHOD(PyObject *name, PyObject **sp);
+int handle_STORE_ATTR(PyObject *owner, PyObject *name, PyObject *value);
 PyObject *handle_BINARY_SUBSCR(PyObject *container, PyObject *sub);
-void handle_STORE_SUBSCR(PyObject *container, PyObject *sub, PyObject *value);
-void handle_DELETE_SUBSCR(PyObject *container, PyObject *sub);
+int handle_STORE_SUBSCR(PyObject *container, PyObject *sub, PyObject *value);
+int handle_DELETE_SUBSCR(PyObject *container, PyObject *sub);
 
 PyObject *handle_UNARY_NOT(PyObject *value);
 PyObject *handle_UNARY_POSITIVE(PyObject *value);
@@ -62,7 +61,7 @@ PyObject *handle_INPLACE_OR(PyObject *v, PyObject *w);
 PyObject *handle_BINARY_XOR(PyObject *v, PyObject *w);
 PyObject *handle_INPLACE_XOR(PyObject *v, PyObject *w);
 PyObject *handle_COMPARE_OP(PyObject *v, PyObject *w, int op);
-PyObject *handle_CONTAINS_OP(PyObject *value, PyObject *container, bool invert);
+int handle_CONTAINS_OP(PyObject *value, PyObject *container);
 
 PyObject *handle_CALL_FUNCTION(PyObject **func_args, Py_ssize_t nargs);
 PyObject *handle_CALL_METHOD(PyObject **func_args, Py_ssize_t nargs);
@@ -74,10 +73,10 @@ PyObject *handle_LOAD_BUILD_CLASS(PyFrameObject *f);
 
 PyObject *handle_IMPORT_NAME(PyFrameObject *f, PyObject *name, PyObject *fromlist, PyObject *level);
 PyObject *handle_IMPORT_FROM(PyObject *from, PyObject *name);
-void handle_IMPORT_STAR(PyFrameObject *f, PyObject *from);
+int handle_IMPORT_STAR(PyFrameObject *f, PyObject *from);
 
 PyObject *handle_GET_ITER(PyObject *o);
-void handle_FOR_ITER(PyObject *iter);
+int handle_FOR_ITER(PyObject *iter);
 
 PyObject *handle_BUILD_STRING(PyObject **arr, Py_ssize_t num);
 PyObject *handle_BUILD_TUPLE(PyObject **arr, Py_ssize_t num);
@@ -85,46 +84,46 @@ PyObject *handle_BUILD_LIST(PyObject **arr, Py_ssize_t num);
 PyObject *handle_BUILD_SET(PyObject **arr, Py_ssize_t num);
 PyObject *handle_BUILD_MAP(PyObject **arr, Py_ssize_t num);
 PyObject *handle_BUILD_CONST_KEY_MAP(PyObject **arr, Py_ssize_t num);
-void handle_LIST_APPEND(PyObject *list, PyObject *value);
-void handle_SET_ADD(PyObject *set, PyObject *value);
-void handle_MAP_ADD(PyObject *map, PyObject *key, PyObject *value);
-void handle_LIST_EXTEND(PyObject *list, PyObject *iterable);
-void handle_SET_UPDATE(PyObject *set, PyObject *iterable);
-void handle_DICT_UPDATE(PyObject *dict, PyObject *update);
-void handle_DICT_MERGE(PyObject *func, PyObject *dict, PyObject *update);
+int handle_LIST_APPEND(PyObject *list, PyObject *value);
+int handle_SET_ADD(PyObject *set, PyObject *value);
+int handle_MAP_ADD(PyObject *map, PyObject *key, PyObject *value);
+int handle_LIST_EXTEND(PyObject *list, PyObject *iterable);
+int handle_SET_UPDATE(PyObject *set, PyObject *iterable);
+int handle_DICT_UPDATE(PyObject *dict, PyObject *update);
+int handle_DICT_MERGE(PyObject *func, PyObject *dict, PyObject *update);
 PyObject *handle_LIST_TO_TUPLE(PyObject *list);
 
 PyObject *handle_FORMAT_VALUE(PyObject *value, PyObject *fmt_spec, int which_conversion);
 PyObject *handle_BUILD_SLICE(PyObject *start, PyObject *stop, PyObject *step);
-void handle_SETUP_ANNOTATIONS(PyFrameObject *f);
-void handle_PRINT_EXPR(PyObject *value);
+int handle_SETUP_ANNOTATIONS(PyFrameObject *f);
+int handle_PRINT_EXPR(PyObject *value);
 
-void handle_UNPACK_SEQUENCE(PyObject *seq, Py_ssize_t num, PyObject **dest);
-void handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_star, PyObject **dest);
+int handle_UNPACK_SEQUENCE(PyObject *seq, Py_ssize_t num, PyObject **dest);
+int handle_UNPACK_EX(PyObject *seq, Py_ssize_t before_star, Py_ssize_t after_star, PyObject **dest);
 
 PyObject *hanlde_GET_LEN(PyObject *value);
-void hanlde_MATCH_KEYS(PyObject **inputs_outputs);
-void hanlde_MATCH_CLASS(Py_ssize_t nargs, PyObject *kwargs, PyObject **inputs_outputs);
+int hanlde_MATCH_KEYS(PyObject **inputs_outputs);
+int hanlde_MATCH_CLASS(Py_ssize_t nargs, PyObject *kwargs, PyObject **inputs_outputs);
 PyObject *handle_COPY_DICT_WITHOUT_KEYS(PyObject *subject, PyObject *keys);
 
-void handle_POP_EXCEPT(PyFrameObject *f, PyObject **exc_triple);
-bool handle_JUMP_IF_NOT_EXC_MATCH(PyObject *left, PyObject *right);
-[[noreturn]] void handle_RERAISE(bool restore_lasti, int stack_height);
-void handle_SETUP_WITH(PyFrameObject *f, int handler, int stack_height);
+int handle_POP_EXCEPT(PyFrameObject *f, PyObject **exc_triple);
+int handle_JUMP_IF_NOT_EXC_MATCH(PyObject *left, PyObject *right);
+bool handle_RERAISE(bool restore_lasti, int stack_height);
+int handle_SETUP_WITH(PyFrameObject *f, int handler, int stack_height);
 PyObject *handle_WITH_EXCEPT_START(PyObject **stack_top);
-[[noreturn]] void handle_RAISE_VARARGS(int argc, int stack_height);
+bool handle_RAISE_VARARGS(int argc, int stack_height);
 
 PyObject *handle_YIELD_VALUE(PyObject *val);
-PyObject *handle_YIELD_FROM(PyObject **inputs_outputs);
+int handle_YIELD_FROM(PyObject **inputs_outputs);
 PyObject *handle_GET_YIELD_FROM_ITER(PyObject *iterable, bool is_coroutine);
 PyObject *handle_GET_AWAITABLE(PyObject *iterable, int prev_prev_op, int prev_op);
 PyObject *handle_GET_AITER(PyObject *obj);
 PyObject *handle_GET_ANEXT(PyObject *aiter);
-void handle_END_ASYNC_FOR(int stack_height);
-void handle_BEFORE_ASYNC_WITH(PyObject **sp);
+bool handle_END_ASYNC_FOR(int stack_height);
+int handle_BEFORE_ASYNC_WITH(PyObject **sp);
 
-bool castPyObjectToBool(PyObject *o);
+int castPyObjectToBool(PyObject *o);
 
-void handleEvalBreaker();
+int handleEvalBreaker();
 
 #endif
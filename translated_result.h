@@ -1,8 +1,6 @@
 #ifndef COMPYLER_TRANSLATED_RESULT_H
 #define COMPYLER_TRANSLATED_RESULT_H
 
-#include <csetjmp>
-
 #include <Python.h>
 #include <internal/pycore_code.h>
 
@@ -13,11 +11,13 @@
 
 inline Py_ssize_t code_extra_index;
 inline PyObject *compyler_module{nullptr};
+inline int safepoint_interval{1};
+inline int specialize_threshold{0x100};
 
 struct ExtendedCFrame : CFrame {
     const struct TranslatedResult *translated_result;
     IntPC handler;
-    jmp_buf frame_jmp_buf;
+    int safepoint_countdown;
 };
 
 using TargetFunction = PyObject *(void *const[], PyFrameObject *, ExtendedCFrame *cframe, void *);
@@ -45,6 +45,75 @@ struct ExeMemBlock {
     static void clear();
 };
 
+// Note: trivial bodies that a call site can evaluate without setting up a frame
+struct InlinableBody {
+    enum Kind : unsigned char {
+        NONE,
+        RETURN_LOCAL,
+        RETURN_CONST,
+        RETURN_ATTR
+    };
+
+    Kind kind;
+    PyOparg operand;
+    PyOparg name;
+
+    static InlinableBody recognize(PyCode py_code);
+};
+
+// Note: exact builtin types that the translated code may assume without checking
+enum class KnownType : unsigned char {
+    ANY,
+    BOOL,
+    INT,
+    FLOAT,
+    STR,
+    TUPLE,
+    LIST,
+    DICT,
+    NONE
+};
+
+inline KnownType classifyType(PyTypeObject *type) {
+    if (type == &PyLong_Type) {
+        return KnownType::INT;
+    } else if (type == &PyFloat_Type) {
+        return KnownType::FLOAT;
+    } else if (type == &PyBool_Type) {
+        return KnownType::BOOL;
+    } else if (type == &PyUnicode_Type) {
+        return KnownType::STR;
+    } else if (type == &PyTuple_Type) {
+        return KnownType::TUPLE;
+    } else if (type == &PyList_Type) {
+        return KnownType::LIST;
+    } else if (type == &PyDict_Type) {
+        return KnownType::DICT;
+    } else if (type == &_PyNone_Type) {
+        return KnownType::NONE;
+    }
+    return KnownType::ANY;
+}
+
+// Note: the exact types of the leading arguments that a specialized version assumes, four bits per argument
+struct ArgTypes {
+    static constexpr unsigned max_arg_num = 8;
+
+    uint32_t bits;
+
+    KnownType get(unsigned i) const {
+        return i < max_arg_num ? static_cast<KnownType>(bits >> (4 * i) & 0xf) : KnownType::ANY;
+    }
+
+    void set(unsigned i, KnownType type) { bits |= static_cast<uint32_t>(type) << (4 * i); }
+
+    explicit operator bool() const { return bits; }
+
+    bool operator==(const ArgTypes &) const = default;
+
+    static unsigned specializableArgs(PyCode py_code);
+};
+
 struct TranslatedResult {
     void *exe_addr;
     ExeMemBlock *exe_mem_block;
@@ -53,6 +122,7 @@ struct TranslatedResult {
     IntVPC *handler_vpc_arr;
     IntPC *handler_pc_arr;
     void *stack_height_arr;
+    InlinableBody inlinable_body;
 
     void *entry_address() const { return exe_addr; }
 
@@ -71,6 +141,20 @@ struct TranslatedResult {
     static void destroy(void *buffer);
 };
 
+// Note: co_extra holds the generic version and the versions specialized for the types of arguments
+struct CodeVersions {
+    static constexpr unsigned max_specialized_num = 4;
+
+    TranslatedResult *generic;
+    unsigned specializable_args;
+    int specialize_countdown;
+    unsigned specialized_num;
+    ArgTypes arg_types[max_specialized_num];
+    TranslatedResult *specialized[max_specialized_num];
+
+    static void destroy(void *buffer);
+};
+
 typedef struct {
     Py_ssize_t ce_size;
     void *ce_extras[1];
@@ -81,9 +165,11 @@ inline bool hasTranslatedResult(PyCodeObject *co) {
     return co_extra && code_extra_index < co_extra->ce_size;
 }
 
-inline auto &getTranslatedResult(PyCodeObject *co) {
+inline auto &getCodeVersions(PyCodeObject *co) {
     auto co_extra = reinterpret_cast<_PyCodeObjectExtra *>(co->co_extra);
-    return *reinterpret_cast<TranslatedResult *>(co_extra->ce_extras[code_extra_index]);
+    return *reinterpret_cast<CodeVersions *>(co_extra->ce_extras[code_extra_index]);
 }
 
+inline auto &getTranslatedResult(PyCodeObject *co) { return *getCodeVersions(co).generic; }
+
 #endif
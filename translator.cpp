@@ -82,6 +82,17 @@ void TranslatedResult::destroy(void *buffer) {
     }
 }
 
+void CodeVersions::destroy(void *buffer) {
+    if (buffer) {
+        auto versions = reinterpret_cast<CodeVersions *>(buffer);
+        TranslatedResult::destroy(versions->generic);
+        for (auto result : PtrRange(versions->specialized, versions->specialized_num)) {
+            TranslatedResult::destroy(result);
+        }
+        delete versions;
+    }
+}
+
 bool Compiler::initialize() {
     static bool llvm_initialized = false;
     if (!llvm_initialized) {
@@ -156,6 +167,11 @@ bool Compiler::compile(Module &mod) {
     text_section = {nullptr, 0};
     data_section = {nullptr, 0};
     for (auto &sec : (*obj)->sections()) {
+#ifndef NDEBUG
+        // The translated code must be position independent
+        auto relocated = sec.getRelocatedSection();
+        assert(relocated && (*relocated == (*obj)->section_end() || !(*relocated)->isText()));
+#endif
         if (sec.isText()) {
             auto contents = sec.getContents();
             if (!contents) {
@@ -164,6 +180,10 @@ bool Compiler::compile(Module &mod) {
             assert(text_section.empty());
             text_section = *contents;
         } else if (sec.isData()) {
+            // Note: the register allocator may leave an unreferenced constant pool for zeroed vectors behind
+            if (auto name = sec.getName(); name && name->startswith(".rodata.cst")) {
+                continue;
+            }
             auto contents = sec.getContents();
             if (!contents) {
                 return set_error(contents);
@@ -68,6 +68,9 @@ class Context {
                     return llvm::Type::getIntNTy(llvm_context, CHAR_BIT * sizeof(T));
                 }
             }
+            if constexpr (std::is_same_v<T, double>) {
+                return llvm::Type::getDoubleTy(llvm_context);
+            }
         }
     };
 
@@ -3,6 +3,7 @@
 
 #include "runtime.h"
 #include "translated_result.h"
+#include "ported/interface.h"
 
 template <auto &symbol>
 struct RuntimeSymbolEntry {};
@@ -44,6 +45,7 @@ struct RuntimeSymbolsHelper<RuntimeSymbolAndNameEntry<symbols, names>...> :
 
 using RuntimeSymbols = RuntimeSymbolsHelper<
         ENTRY(raiseUnboundError),
+        ENTRY(handleError),
 
         ENTRY(handle_ROT_N),
         ENTRY(handle_LOAD_CLASSDEREF),
@@ -155,8 +157,23 @@ using RuntimeSymbols = RuntimeSymbolsHelper<
 
         ENTRY(castPyObjectToBool),
 
-        ENTRY(handleEvalBreaker),
+        ENTRY(PyTuple_New),
+        ENTRY(PyList_New),
+        ENTRY(PyLong_FromLong),
+        ENTRY(PyFloat_FromDouble),
 
+        ENTRY(handleEvalBreaker),
+        ENTRY(safepoint_interval),
+        ENTRY(deoptimized_frame),
+
+        ENTRY(PyLong_Type),
+        ENTRY(PyUnicode_Type),
+        ENTRY(PyTuple_Type),
+        ENTRY(PyList_Type),
+        ENTRY(PyDict_Type),
+        ENTRY(PySet_Type),
+        ENTRY(PyFrozenSet_Type),
+        ENTRY(_Py_NoneStruct),
         ENTRY(_Py_FalseStruct),
         ENTRY(_Py_TrueStruct),
         ENTRY(PyExc_AssertionError)
@@ -188,6 +205,11 @@ struct TypeNormalizer<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same
     using type = std::make_signed_t<T>;
 };
 
+template <typename T>
+struct TypeNormalizer<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    using type = T;
+};
+
 template <typename T>
 struct TypeNormalizer<T, std::enable_if_t<!std::is_scalar_v<T> && !std::is_function_v<T>>> {
     using type = void;